@@ -0,0 +1,134 @@
+#!/usr/bin/env bash
+set -eu
+
+usage() {
+	cat <<"EOF"
+Times RGBASM on generated inputs which stress specific parts of it.
+Usage: benchmark.bash [options] <case>...
+Options:
+    -h, --help          show this help message
+    --rgbasm <path>     benchmark this RGBASM binary (default: ./rgbasm)
+    --runs <n>          assemble each input <n> times and keep the fastest (default: 5)
+    --keep <dir>        write the generated inputs to <dir> instead of a temporary directory
+Cases:
+    keywords    instructions and directives, in both cases, between many labels
+    incbin      whole banks and many small slices of one 1 MiB file
+    charmap     a dialogue script converted through 76 charmap mappings
+EOF
+}
+
+# Parse options in pure Bash because macOS `getopt` is stuck
+# in what util-linux `getopt` calls `GETOPT_COMPATIBLE` mode
+rgbasm=./rgbasm
+runs=5
+workdir=
+cases=()
+while [[ $# -gt 0 ]]; do
+	case "$1" in
+		-h|--help)
+			usage
+			exit 0
+			;;
+		--rgbasm)
+			shift
+			rgbasm="$1"
+			;;
+		--runs)
+			shift
+			runs="$1"
+			;;
+		--keep)
+			shift
+			workdir="$1"
+			;;
+		-*)
+			echo "$(basename "$0"): unknown option '$1'"
+			exit 1
+			;;
+		*)
+			cases+=("$1")
+			;;
+	esac
+	shift
+done
+if [[ ${#cases[@]} -eq 0 ]]; then
+	usage
+	exit 1
+fi
+
+rgbasm="$(cd "$(dirname "$rgbasm")" && pwd)/$(basename "$rgbasm")"
+if [[ -z "$workdir" ]]; then
+	workdir="$(mktemp -d)"
+	trap 'rm -rf "$workdir"' EXIT
+fi
+mkdir -p "$workdir"
+cd "$workdir"
+
+# Each generator writes `<case>.asm`, plus any files that it includes
+
+gen_keywords() {
+	awk 'BEGIN {
+		for (i = 0; i < 60000; i++) {
+			if (i % 1000 == 0) printf "SECTION \"Code %d\", ROMX\n", i / 1000
+			printf "Label%d:\n", i
+			printf "\tld a, [hl+]\n\tLD B, C\n\tXor a\n\tjr nz, Label%d\n", i
+			printf "\tDEF Const%d EQU %d\n\tld de, Const%d * 2\n", i, i % 4096, i
+			printf ".local%d\n\tPUSH af\n\tpop AF\n\tret c\n", i
+		}
+	}' >keywords.asm
+}
+
+gen_incbin() {
+	yes RGBDS | head -c 1048576 >incbin.bin
+	awk 'BEGIN {
+		for (i = 0; i < 64; i++) {
+			printf "SECTION \"Bank %d\", ROMX\n\tINCBIN \"incbin.bin\", %d, 16384\n", i, i * 16384
+		}
+		for (i = 0; i < 16384; i++) {
+			if (i % 64 == 0) printf "SECTION \"Slices %d\", ROMX\n", i / 64
+			printf "\tINCBIN \"incbin.bin\", %d, 256\n", (i * 4099) % (1048576 - 256)
+		}
+	}' >incbin.asm
+}
+
+gen_charmap() {
+	awk 'BEGIN {
+		chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789 ,.!?-"
+		for (i = 1; i <= length(chars); i++) {
+			printf "CHARMAP \"%s\", $%02X\n", substr(chars, i, 1), 0x80 + i
+		}
+		split("'"'"'s '"'"'t '"'"'re <PLAYER> <RIVAL> <NEXT> <PROMPT> @", multi, " ")
+		for (i = 1; i in multi; i++) {
+			printf "CHARMAP \"%s\", $%02X\n", multi[i], 0x40 + i
+		}
+		split("Hello <PLAYER>! It'"'"'s a fine day.<NEXT>|<RIVAL> isn'"'"'t here, they'"'"'re out.<PROMPT>|" \
+		      "Route 12 is north of here, past 3 trees!@|Are you ready? We'"'"'re set, 99 things to do.", \
+		      lines, "|")
+		for (i = 0; i < 100000; i++) {
+			if (i % 200 == 0) printf "SECTION \"Text %d\", ROMX\n", i / 200
+			printf "Text%d:\n\tdb \"%s\"\n", i, lines[i % 4 + 1]
+		}
+	}' >charmap.asm
+}
+
+for case in "${cases[@]}"; do
+	if ! declare -F "gen_$case" >/dev/null; then
+		echo "$(basename "$0"): unknown case '$case'"
+		exit 1
+	fi
+	"gen_$case"
+	if ! "$rgbasm" -o "$case.o" "$case.asm" >/dev/null; then
+		echo "$(basename "$0"): $rgbasm failed to assemble $case.asm"
+		exit 1
+	fi
+
+	best=
+	for (( run = 0; run < runs; run++ )); do
+		TIMEFORMAT=%R
+		elapsed="$({ time "$rgbasm" -o "$case.o" "$case.asm" >/dev/null 2>&1; } 2>&1)"
+		if [[ -z "$best" ]] || awk "BEGIN { exit !($elapsed < $best) }"; then
+			best="$elapsed"
+		fi
+	done
+	printf "%-10s %ss\n" "$case" "$best"
+done
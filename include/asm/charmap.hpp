@@ -27,6 +27,9 @@ size_t charmap_CharSize(std::string const &mapping);
 std::optional<int32_t> charmap_CharValue(std::string const &mapping, size_t idx);
 std::vector<int32_t> charmap_Convert(std::string const &input);
 size_t charmap_ConvertNext(std::string_view &input, std::vector<int32_t> *output);
+// Returns the offsets of the units that `charmap_ConvertNext` would split `input` into, then its
+// length; or `nullptr` if converting it would report any diagnostic
+std::vector<size_t> const *charmap_UnitOffsets(std::string const &input);
 std::string charmap_Reverse(std::vector<int32_t> const &value, bool &unique);
 
 #endif // RGBDS_ASM_CHARMAP_HPP
@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -18,11 +19,20 @@
 #include "asm/intern.hpp"
 #include "asm/lexer.hpp"
 
+struct FileStackNode;
+
+// Where a macro node's name comes from, until that name is needed and built
+struct MacroNodeSource {
+	std::shared_ptr<FileStackNode> defNode; // Node where the macro was defined
+	InternedStr macroName;
+};
+
 struct FileStackNode {
 	FileStackNodeType type;
-	std::variant<
-	    std::vector<uint32_t>, // NODE_REPT
-	    std::string            // NODE_FILE, NODE_MACRO
+	mutable std::variant<
+	    uint32_t,       // NODE_REPT
+	    std::string,    // NODE_FILE, NODE_MACRO
+	    MacroNodeSource // NODE_MACRO, until `name()` is first called
 	    >
 	    data;
 	bool isQuiet; // Whether to omit this node from error reporting
@@ -35,19 +45,20 @@ struct FileStackNode {
 	// Set only if referenced: ID within the object file, `UINT32_MAX` if not output yet
 	uint32_t ID = UINT32_MAX;
 
+	// REPT iteration count of this node; outer ones are stored by its parent REPT nodes
+	uint32_t &iter() { return std::get<uint32_t>(data); }
+	uint32_t iter() const { return std::get<uint32_t>(data); }
 	// REPT iteration counts since last named node, in reverse depth order
-	std::vector<uint32_t> &iters() { return std::get<std::vector<uint32_t>>(data); }
-	std::vector<uint32_t> const &iters() const { return std::get<std::vector<uint32_t>>(data); }
-	// File name for files, file::macro name for macros
-	std::string &name() { return std::get<std::string>(data); }
-	std::string const &name() const { return std::get<std::string>(data); }
+	std::vector<uint32_t> iters() const;
+	// File name for files, file::macro name for macros (built on first use)
+	std::string const &name() const;
 
 	FileStackNode(
 	    FileStackNodeType type_,
-	    std::variant<std::vector<uint32_t>, std::string> data_,
+	    std::variant<uint32_t, std::string, MacroNodeSource> data_,
 	    bool isQuiet_
 	)
-	    : type(type_), data(data_), isQuiet(isQuiet_) {}
+	    : type(type_), data(std::move(data_)), isQuiet(isQuiet_) {}
 
 	void printBacktrace(uint32_t curLineNo) const;
 };
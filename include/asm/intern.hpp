@@ -4,29 +4,74 @@
 #define RGBDS_ASM_INTERN_HPP
 
 #include <stddef.h>
-#include <string>
+#include <stdint.h>
 #include <string_view>
 #include <utility> // hash
 
+#include "helpers.hpp" // assume
+
+// Each interned string is stored in an arena, preceded by this header
+struct InternedHeader {
+	size_t index;      // Order in which the string was interned
+	size_t length;     // Length of the string, which is followed by a NUL terminator
+	size_t dotPos;     // Position of the first '.', or `std::string_view::npos` if none
+	bool hasNestedDot; // Whether there is another '.' after the first one
+};
+
+// Anonymous labels are not interned, so their names are only built if they are needed
+char const *anonLabelChars(uint32_t id);
+
 class InternedStr {
-	size_t index;
+	// Either points right after an `InternedHeader` in the arena (which is aligned, so even),
+	// or holds an anonymous label's ID shifted left by one with the low bit set
+	uint64_t bits;
+
+	char const *chars() const {
+		assume(bits != 0);
+		return isAnonLabel() ? anonLabelChars(anonLabelID())
+		                     : reinterpret_cast<char const *>(static_cast<uintptr_t>(bits));
+	}
+
+	InternedHeader const &header() const {
+		return reinterpret_cast<InternedHeader const *>(chars())[-1];
+	}
 
 public:
-	constexpr InternedStr() : index(static_cast<size_t>(-1)) {}
-	explicit constexpr InternedStr(size_t index_) : index(index_) {}
+	constexpr InternedStr() : bits(0) {}
+	explicit InternedStr(char const *chars_) : bits(reinterpret_cast<uintptr_t>(chars_)) {}
+
+	static InternedStr anonLabel(uint32_t id) {
+		InternedStr str;
+		str.bits = static_cast<uint64_t>(id) << 1 | 1;
+		return str;
+	}
 
-	std::string const &str() const;
-	char const *c_str() const { return str().c_str(); }
+	bool isAnonLabel() const { return bits & 1; }
+	uint32_t anonLabelID() const {
+		assume(isAnonLabel());
+		return bits >> 1;
+	}
 
-	bool operator==(InternedStr const &rhs) const { return index == rhs.index; }
+	// Interned strings are densely indexed in the order they were interned
+	size_t index() const {
+		assume(!isAnonLabel());
+		return header().index;
+	}
+	std::string_view str() const { return std::string_view{chars(), header().length}; }
+	char const *c_str() const { return chars(); }
+	// The position of dots is used to qualify local labels
+	size_t dotPos() const { return isAnonLabel() ? std::string_view::npos : header().dotPos; }
+	bool hasNestedDot() const { return !isAnonLabel() && header().hasNestedDot; }
 
-	template<typename T>
-	friend struct std::hash;
+	bool operator==(InternedStr const &rhs) const { return bits == rhs.bits; }
 };
 
 template<>
 struct std::hash<InternedStr> {
-	size_t operator()(InternedStr const &str) const { return std::hash<size_t>{}(str.index); }
+	size_t operator()(InternedStr const &str) const {
+		return str.isAnonLabel() ? std::hash<uint32_t>{}(str.anonLabelID())
+		                         : std::hash<size_t>{}(str.index());
+	}
 };
 
 InternedStr intern(std::string_view str);
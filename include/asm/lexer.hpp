@@ -9,6 +9,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "asm/intern.hpp"
@@ -24,18 +25,28 @@ enum LexerMode {
 
 struct Expansion {
 	std::optional<InternedStr> name;
-	std::shared_ptr<std::string> contents;
+	std::shared_ptr<std::string> owner; // Keeps the viewed `contents` alive
+	std::string_view contents;
 	size_t offset; // Cursor into `contents`
 
-	size_t size() const { return contents->size(); }
+	size_t size() const { return contents.size(); }
 	bool advance(); // Increment `offset`; return whether it then exceeds `contents`
 };
 
+struct KeywordIndex;
+
 struct ContentSpan {
 	std::shared_ptr<char[]> ptr;
 	size_t size;
+	// Built on demand to skip straight to leading keywords (only used for source files)
+	std::shared_ptr<KeywordIndex> keywordIndex = nullptr;
+	// Sorted offsets of all '\\' and '{' chars, the only ones which can begin an expansion
+	// (only computed for captured `MACRO` and `REPT`/`FOR` bodies)
+	std::shared_ptr<std::vector<size_t>> expansionOffsets = nullptr;
 };
 
+struct TokenCache;
+
 struct IfStackEntry {
 	bool ranIfBlock;       // Whether an IF/ELIF/ELSE block ran already
 	bool reachedElseBlock; // Whether an ELSE block ran already
@@ -64,18 +75,30 @@ struct LexerState {
 	ContentSpan content; // Span of chars
 	size_t offset = 0;   // Cursor into `content.ptr`
 
+	size_t nextExpansionIdx; // Index of the next offset to reach in `content.expansionOffsets`
+	size_t expansionFreeEnd; // No expansion can begin before this offset into `content.ptr`
+
+	std::shared_ptr<TokenCache> tokenCache; // Tokens to replay in later iterations of a loop
+
 	~LexerState();
 
 	int peekChar();
 	int peekCharAhead();
+	void updateExpansionFreeEnd();
 
 	void setAsCurrentState();
 	void setFileAsNextState(std::string const &filePath, bool updateStateNow);
 	void setViewAsNextState(char const *name, ContentSpan const &content_, uint32_t lineNo_);
+	void enableTokenCache();
 
 	void clear(uint32_t lineNo_);
 };
 
+void lexer_VerboseOutputStats();
+// Loads a regular file's contents, shared with any previous loads of the same unchanged file;
+// returns `std::nullopt` if the file is not regular or cannot be read
+std::optional<ContentSpan> lexer_LoadFile(std::string const &path);
+
 void lexer_SetBinDigits(char const digits[2]);
 void lexer_SetGfxDigits(char const digits[4]);
 
@@ -4,20 +4,28 @@
 #define RGBDS_ASM_MACRO_HPP
 
 #include <memory>
+#include <optional>
+#include <stddef.h>
 #include <stdint.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 struct MacroArgs {
-	uint32_t shift;
-	std::vector<std::shared_ptr<std::string>> args;
+	uint32_t shift = 0;
+	// All the args, each followed by a comma, so that `\#` is always a suffix of this buffer
+	std::shared_ptr<std::string> buffer = std::make_shared<std::string>();
+	std::vector<size_t> offsets; // Start of each arg within `buffer`
 
-	uint32_t nbArgs() const { return args.size() - shift; }
-	std::shared_ptr<std::string> getArg(int32_t num) const;
-	std::shared_ptr<std::string> getAllArgs() const;
+	uint32_t nbArgs() const { return offsets.size() - shift; }
+	std::optional<std::string_view> getArg(int32_t num) const;
+	std::string_view getAllArgs() const;
 
-	void appendArg(std::shared_ptr<std::string> arg);
+	void appendArg(std::string const &arg);
 	void shiftArgs(int32_t count);
+
+private:
+	std::string_view argAt(size_t i) const;
 };
 
 #endif // RGBDS_ASM_MACRO_HPP
@@ -27,6 +27,8 @@ struct Options {
 	std::optional<std::string> targetFileName{};    // -MQ, -MT
 	MissingInclude missingIncludeState = INC_ERROR; // -MC, -MG
 	bool generatePhonyDeps = false;                 // -MP
+	bool listIncludeDirs = false;                   // --list-include-dirs
+	bool compactObject = false;                     // --compact-object
 	std::optional<std::string> objectFileName{};    // -o
 	uint8_t padByte = 0;                            // -p
 	uint64_t maxErrors = 0;                         // -X
@@ -22,6 +22,8 @@ void out_CreatePatch(uint32_t type, Expression const &expr, uint32_t ofs, uint32
 void out_CreateAssert(
     AssertionType type, Expression const &expr, std::string const &message, uint32_t ofs
 );
+// Serializes the object file to `buffer`, e.g. to hand it off without writing it to disk
+void out_SerializeObject(std::vector<uint8_t> &buffer);
 void out_WriteObject();
 void out_WriteState(std::string name, std::vector<StateFeature> const &features);
 
@@ -3,8 +3,12 @@
 #ifndef RGBDS_ASM_RPN_HPP
 #define RGBDS_ASM_RPN_HPP
 
+#include <new>
+#include <stddef.h>
 #include <stdint.h>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -26,13 +30,81 @@ struct RPNValue {
 	void appendEncoded(std::vector<uint8_t> &buffer) const;
 };
 
+// Most expressions are a single number or symbol, so one RPN value is stored inline; storing
+// more would enlarge every `Expression`, and thus every value on the parser stack
+class RPNValues {
+	static constexpr size_t INLINE_CAPACITY = 1;
+	static_assert(std::is_trivially_copyable_v<RPNValue>);
+
+	alignas(RPNValue) unsigned char inlineStorage[INLINE_CAPACITY * sizeof(RPNValue)];
+	size_t nbInline = 0;
+	std::vector<RPNValue> heapValues; // Only used (instead of the inline values) once full
+
+	RPNValue *inlineValues() { return reinterpret_cast<RPNValue *>(inlineStorage); }
+	RPNValue const *inlineValues() const {
+		return reinterpret_cast<RPNValue const *>(inlineStorage);
+	}
+
+public:
+	size_t size() const { return heapValues.empty() ? nbInline : heapValues.size(); }
+	bool empty() const { return size() == 0; }
+
+	RPNValue const *begin() const {
+		return heapValues.empty() ? inlineValues() : heapValues.data();
+	}
+	RPNValue const *end() const { return begin() + size(); }
+	RPNValue const &operator[](size_t i) const { return begin()[i]; }
+
+	template<typename... ArgsT>
+	void emplace_back(ArgsT &&...args) {
+		if (heapValues.empty() && nbInline < INLINE_CAPACITY) {
+			new (&inlineValues()[nbInline++]) RPNValue(std::forward<ArgsT>(args)...);
+			return;
+		}
+		if (heapValues.empty()) {
+			heapValues.reserve(INLINE_CAPACITY * 2);
+			heapValues.assign(inlineValues(), inlineValues() + nbInline);
+			nbInline = 0;
+		}
+		heapValues.emplace_back(std::forward<ArgsT>(args)...);
+	}
+
+	void append(RPNValues const &other) {
+		for (RPNValue const &val : other) {
+			emplace_back(val);
+		}
+	}
+};
+
+// Why an expression's value is not known; only formatted into text if it gets reported
+struct UnknownReason {
+	enum Kind : uint8_t {
+		PC_NOT_CONSTANT,
+		SYM_NOT_CONSTANT,
+		SYM_UNDEFINED,
+		BANK_SELF,
+		BANK_SYM,
+		BANK_SECT,
+		SIZEOF_SECT,
+		STARTOF_SECT,
+		SIZEOF_SECTTYPE,
+		STARTOF_SECTTYPE,
+	};
+
+	Kind kind;
+	bool isPurged = false; // Whether the symbol was purged, if any
+	InternedStr name{};    // Name of the symbol or section, if any
+
+	std::string str() const;
+};
+
 struct Expression {
 	std::variant<
-	    int32_t,    // If the expression's value is known, it's here
-	    std::string // Why the expression is not known, if it isn't
+	    int32_t,      // If the expression's value is known, it's here
+	    UnknownReason // Why the expression is not known, if it isn't
 	    >
 	    data = 0;
-	std::vector<RPNValue> rpn{}; // Values to be serialized into the RPN expression
+	RPNValues rpn{}; // Values to be serialized into the RPN expression
 
 	bool isKnown() const { return std::holds_alternative<int32_t>(data); }
 	int32_t value() const { return std::get<int32_t>(data); }
@@ -58,7 +130,7 @@ struct Expression {
 
 	void checkNBit(uint8_t n) const;
 
-	void encode(std::vector<uint8_t> &buffer) const;
+	void encode(std::vector<uint8_t> &buffer) const; // Appends to `buffer`
 };
 
 bool checkNBit(int32_t v, uint8_t n, char const *name);
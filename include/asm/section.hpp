@@ -19,13 +19,14 @@ struct FileStackNode;
 struct Section;
 
 struct Patch {
-	std::shared_ptr<FileStackNode> src;
+	uint32_t srcID; // ID of the (registered) file stack node within the object file
 	uint32_t lineNo;
 	uint32_t offset;
 	Section *pcSection;
 	uint32_t pcOffset;
 	uint8_t type;
-	std::vector<uint8_t> rpn;
+	uint32_t rpnOfs;  // Offset of the serialized RPN in its owner's RPN buffer
+	uint32_t rpnSize; // Size of the serialized RPN in its owner's RPN buffer
 };
 
 struct Section {
@@ -40,6 +41,7 @@ struct Section {
 	uint8_t align; // Exactly as specified in `ALIGN[]`
 	uint16_t alignOfs;
 	std::deque<Patch> patches;
+	std::vector<uint8_t> rpnData; // Serialized RPN of all `patches`, stored contiguously
 	std::vector<uint8_t> data;
 
 	uint32_t getID() const; // ID of the section in the object file (`UINT32_MAX` if none)
@@ -78,7 +80,7 @@ uint32_t sect_GetSymbolOffset();
 uint32_t sect_GetOutputOffset();
 std::optional<uint32_t> sect_GetOutputBank();
 
-Patch *sect_AddOutputPatch();
+Section *sect_GetOutputSection();
 
 uint32_t sect_GetAlignBytes(uint8_t alignment, uint16_t offset);
 void sect_AlignPC(uint8_t alignment, uint16_t offset);
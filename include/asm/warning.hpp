@@ -4,6 +4,7 @@
 #define RGBDS_ASM_WARNING_HPP
 
 #include <functional>
+#include <stdint.h>
 
 #include "diagnostics.hpp"
 
@@ -55,6 +56,9 @@ enum WarningID {
 
 extern Diagnostics<WarningLevel, WarningID> warnings;
 
+// Number of diagnostics reported so far, including disabled warnings
+extern uint64_t nbDiagnostics;
+
 // Used to warn the user about problems that don't prevent the generation of
 // valid code.
 [[gnu::format(printf, 2, 3)]]
@@ -15,7 +15,7 @@ struct FileStackNode {
 	FileStackNodeType type;
 	std::variant<
 	    std::monostate,        // Default constructed; `.type` and `.data` must be set manually
-	    std::vector<uint32_t>, // NODE_REPT
+	    uint32_t,              // NODE_REPT
 	    std::string            // NODE_FILE, NODE_MACRO
 	    >
 	    data;
@@ -25,9 +25,9 @@ struct FileStackNode {
 	// Line at which the parent context was exited; meaningless for the root level
 	uint32_t lineNo;
 
-	// REPT iteration counts since last named node, in reverse depth order
-	std::vector<uint32_t> &iters() { return std::get<std::vector<uint32_t>>(data); }
-	std::vector<uint32_t> const &iters() const { return std::get<std::vector<uint32_t>>(data); }
+	// REPT iteration count of this node; outer ones are stored by its parent REPT nodes
+	uint32_t &iter() { return std::get<uint32_t>(data); }
+	uint32_t iter() const { return std::get<uint32_t>(data); }
 	// File name for files, file::macro name for macros
 	std::string &name() { return std::get<std::string>(data); }
 	std::string const &name() const { return std::get<std::string>(data); }
@@ -9,7 +9,10 @@
 #include "helpers.hpp" // assume
 
 #define RGBDS_OBJECT_VERSION_STRING "RGB9"
-#define RGBDS_OBJECT_REV            13U
+#define RGBDS_OBJECT_REV            14U
+
+#define RGBDS_COMPACT_OBJECT_VERSION_STRING "RGBC"
+#define RGBDS_COMPACT_OBJECT_REV            1U
 
 enum AssertionType { ASSERT_WARN, ASSERT_ERROR, ASSERT_FATAL };
 
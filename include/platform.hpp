@@ -55,12 +55,26 @@
 	#define setmode(fd, mode) (0)
 #endif
 
+// MSVC prefixes `getpid` with an underscore
+#ifdef _MSC_VER
+	#include <process.h> // IWYU pragma: export
+	#define getpid _getpid
+#endif
+
 // Windows has 32-bit `long`, which limits `fseek` and `ftell` to 2 GiB
 #if defined(_MSC_VER) || defined(__MINGW32__)
 	#define fseek _fseeki64
 	#define ftell _ftelli64
 #endif
 
+// Windows does not have `mmap`, so files are read into memory instead
+#if defined(_MSC_VER) || defined(__MINGW32__)
+	#define HAVE_MMAP 0
+#else
+	#include <sys/mman.h> // IWYU pragma: export
+	#define HAVE_MMAP 1
+#endif
+
 // MingGW and Cygwin may need POSIX functions which are not standard C explicitly enabled
 #if (defined(__MINGW32__) || defined(__CYGWIN__)) && !defined(_POSIX_C_SOURCE)
 	#define _POSIX_C_SOURCE 200809L
@@ -9,8 +9,11 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "helpers.hpp"
 
@@ -39,6 +42,9 @@ bool isLower(int c);
 bool isLetter(int c);
 bool isAlphanumeric(int c);
 
+// Find the first newline char in [ptr, end), or `end` if there is none
+char const *findNewline(char const *ptr, char const *end);
+
 // Locale-independent character transform functions
 char toLower(char c);
 char toUpper(char c);
@@ -105,4 +111,60 @@ struct Uppercase {
 template<typename ItemT>
 using UpperMap = std::unordered_map<std::string_view, ItemT, Uppercase, Uppercase>;
 
+// A fixed map from case-insensitive `std::string_view` keys to `ItemT` items, for small sets of
+// keywords; lookups only compare the keys with the same length and first char (ignoring case)
+template<typename ItemT>
+class KeywordMap {
+	// Convert an ASCII lowercase letter to uppercase without branching
+	static constexpr char foldUpper(char c) {
+		return c ^ (static_cast<unsigned char>(c - 'a') < 26) << 5;
+	}
+
+	// Letters have the same low 5 bits regardless of case, so they index the same bucket
+	static constexpr size_t bucketIndex(std::string_view key) {
+		return key.length() << 5 | (key[0] & 0x1F);
+	}
+
+	size_t maxLength = 0;
+	std::vector<std::pair<std::string, ItemT>> entries; // Sorted by bucket, with uppercase keys
+	std::vector<size_t> bucketStarts; // Index in `entries` of the first entry of each bucket
+
+public:
+	KeywordMap(std::initializer_list<std::pair<std::string_view, ItemT>> items) {
+		for (auto const &[key, item] : items) {
+			std::string upperKey(key.length(), '\0');
+			std::transform(RANGE(key), upperKey.begin(), foldUpper);
+			entries.emplace_back(std::move(upperKey), item);
+			maxLength = std::max(maxLength, key.length());
+		}
+		std::stable_sort(RANGE(entries), [](auto const &lhs, auto const &rhs) {
+			return bucketIndex(lhs.first) < bucketIndex(rhs.first);
+		});
+
+		bucketStarts.resize(((maxLength + 1) << 5) + 1);
+		for (size_t i = 0, bucket = 0; bucket < bucketStarts.size(); ++bucket) {
+			while (i < entries.size() && bucketIndex(entries[i].first) < bucket) {
+				++i;
+			}
+			bucketStarts[bucket] = i;
+		}
+	}
+
+	ItemT const *find(std::string_view key) const {
+		if (key.empty() || key.length() > maxLength) {
+			return nullptr;
+		}
+		size_t bucket = bucketIndex(key);
+		for (size_t i = bucketStarts[bucket]; i < bucketStarts[bucket + 1]; ++i) {
+			if (auto const &[upperKey, item] = entries[i];
+			    std::equal(RANGE(key), upperKey.begin(), [](char c, char upper) {
+				    return foldUpper(c) == upper;
+			    })) {
+				return &item;
+			}
+		}
+		return nullptr;
+	}
+};
+
 #endif // RGBDS_UTIL_HPP
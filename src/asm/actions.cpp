@@ -2,6 +2,7 @@
 
 #include "asm/actions.hpp"
 
+#include <algorithm>
 #include <errno.h>
 #include <inttypes.h>
 #include <optional>
@@ -277,7 +278,71 @@ static void errorInvalidUTF8Byte(uint8_t byte, char const *functionName) {
 	error("%s: Invalid UTF-8 byte 0x%02hhX", functionName, byte);
 }
 
-size_t act_StringLen(std::string const &str, bool printErrors) {
+// Checks whether a string is all ASCII, 8 bytes at a time
+static bool isAscii(std::string const &str) {
+	size_t i = 0;
+	for (uint64_t word; i + sizeof(word) <= str.length(); i += sizeof(word)) {
+		memcpy(&word, &str[i], sizeof(word));
+		if (word & UINT64_C(0x8080808080808080)) {
+			return false;
+		}
+	}
+	for (; i < str.length(); ++i) {
+		if (str[i] & 0x80) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Offsets of a valid UTF-8 string's characters, so that string functions can index them directly
+struct Utf8Index {
+	bool isAscii;
+	std::vector<size_t> offsets; // Start of each character, then the end; empty if `isAscii`
+	size_t strLen;
+
+	size_t length() const { return isAscii ? strLen : offsets.size() - 1; }
+	size_t offset(size_t idx) const { return isAscii ? idx : offsets[idx]; }
+};
+
+// Indexes a string, or returns `nullptr` if it is not valid UTF-8 (so that the functions report
+// errors as they decode it). Loops tend to call the functions on the same string repeatedly, so the
+// last non-ASCII string's index is kept.
+static Utf8Index const *indexUtf8(std::string const &str) {
+	static Utf8Index asciiIndex{.isAscii = true, .offsets = {}, .strLen = 0};
+	static std::string lastStr;
+	static std::optional<Utf8Index> lastIndex;
+
+	if (isAscii(str)) {
+		asciiIndex.strLen = str.length();
+		return &asciiIndex;
+	}
+	if (lastIndex && str == lastStr) {
+		return &*lastIndex;
+	}
+
+	Utf8Index index{.isAscii = false, .offsets = {}, .strLen = str.length()};
+	Utf8Decoder decoder;
+	for (size_t i = 0; i < str.length(); ++i) {
+		if (decoder.state == UTF8_ACCEPT) {
+			index.offsets.push_back(i);
+		}
+		if (decoder.update(str[i]) == UTF8_REJECT) {
+			return nullptr;
+		}
+	}
+	if (decoder.state != UTF8_ACCEPT) {
+		return nullptr;
+	}
+	index.offsets.push_back(str.length());
+
+	lastStr = str;
+	lastIndex = std::move(index);
+	return &*lastIndex;
+}
+
+// Counts a string's characters by decoding it, for strings which `indexUtf8` rejects
+static size_t decodedLength(std::string const &str, bool printErrors) {
 	size_t len = 0;
 	Utf8Decoder decoder;
 
@@ -308,12 +373,43 @@ size_t act_StringLen(std::string const &str, bool printErrors) {
 	return len;
 }
 
+size_t act_StringLen(std::string const &str, bool printErrors) {
+	if (Utf8Index const *index = indexUtf8(str); index) {
+		return index->length();
+	}
+	return decodedLength(str, printErrors);
+}
+
 std::string
     act_StringSlice(std::string const &str, int32_t negStart, std::optional<int32_t> negStop) {
-	size_t adjustLen = act_StringLen(str, false);
+	Utf8Index const *utf8Index = indexUtf8(str);
+	size_t adjustLen = utf8Index ? utf8Index->length() : decodedLength(str, false);
 	uint32_t start = adjustNegativeIndex(negStart, adjustLen, "STRSLICE");
 	uint32_t stop = negStop ? adjustNegativeIndex(*negStop, adjustLen, "STRSLICE") : adjustLen;
 
+	if (utf8Index) {
+		size_t len = adjustLen;
+		size_t startIdx = std::min<size_t>(start, len);
+		size_t stopIdx = std::max(startIdx, std::min<size_t>(stop, len));
+		if (start > len) {
+			warning(
+			    WARNING_BUILTIN_ARG,
+			    "STRSLICE: Start index %" PRIu32 " is past the end of the string",
+			    start
+			);
+		}
+		if (stopIdx < stop) {
+			warning(
+			    WARNING_BUILTIN_ARG,
+			    "STRSLICE: Stop index %" PRIu32 " is past the end of the string",
+			    stop
+			);
+		}
+		return str.substr(
+		    utf8Index->offset(startIdx), utf8Index->offset(stopIdx) - utf8Index->offset(startIdx)
+		);
+	}
+
 	size_t strLen = str.length();
 	size_t index = 0;
 	Utf8Decoder decoder;
@@ -379,10 +475,29 @@ std::string
 std::string act_StringSub(std::string const &str, int32_t negPos, std::optional<uint32_t> optLen) {
 	warning(WARNING_OBSOLETE, "`STRSUB` is deprecated; use 0-indexed `STRSLICE` instead");
 
-	size_t adjustLen = act_StringLen(str, false);
+	Utf8Index const *utf8Index = indexUtf8(str);
+	size_t adjustLen = utf8Index ? utf8Index->length() : decodedLength(str, false);
 	uint32_t pos = adjustNegativePos(negPos, adjustLen, "STRSUB");
 	uint32_t len = optLen ? *optLen : pos > adjustLen ? 0 : adjustLen + 1 - pos;
 
+	if (utf8Index) {
+		size_t strLen = adjustLen;
+		size_t startIdx = std::min<size_t>(pos - 1, strLen);
+		size_t subLen = std::min<size_t>(len, strLen - startIdx);
+		if (pos - 1 > strLen) {
+			warning(
+			    WARNING_BUILTIN_ARG,
+			    "STRSUB: Position %" PRIu32 " is past the end of the string",
+			    pos
+			);
+		}
+		if (subLen < len) {
+			warning(WARNING_BUILTIN_ARG, "STRSUB: Length too big: %" PRIu32, len);
+		}
+		size_t startOfs = utf8Index->offset(startIdx);
+		return str.substr(startOfs, utf8Index->offset(startIdx + subLen) - startOfs);
+	}
+
 	size_t strLen = str.length();
 	size_t index = 0;
 	Utf8Decoder decoder;
@@ -440,7 +555,8 @@ std::string act_StringSub(std::string const &str, int32_t negPos, std::optional<
 	return str.substr(startIndex, index - startIndex);
 }
 
-size_t act_CharLen(std::string const &str) {
+// Counts a string's charmap units by converting it, for strings which `charmap_UnitOffsets` rejects
+static size_t convertedLength(std::string const &str) {
 	std::string_view view = str;
 	size_t len;
 
@@ -449,10 +565,28 @@ size_t act_CharLen(std::string const &str) {
 	return len;
 }
 
+size_t act_CharLen(std::string const &str) {
+	if (std::vector<size_t> const *offsets = charmap_UnitOffsets(str); offsets) {
+		return offsets->size() - 1;
+	}
+	return convertedLength(str);
+}
+
 std::string act_StringChar(std::string const &str, int32_t negIdx) {
-	size_t adjustLen = act_CharLen(str);
+	std::vector<size_t> const *offsets = charmap_UnitOffsets(str);
+	size_t adjustLen = offsets ? offsets->size() - 1 : convertedLength(str);
 	uint32_t idx = adjustNegativeIndex(negIdx, adjustLen, "STRCHAR");
 
+	if (offsets) {
+		if (idx >= adjustLen) {
+			warning(
+			    WARNING_BUILTIN_ARG, "STRCHAR: Index %" PRIu32 " is past the end of the string", idx
+			);
+			return "";
+		}
+		return str.substr((*offsets)[idx], (*offsets)[idx + 1] - (*offsets)[idx]);
+	}
+
 	std::string_view view = str;
 	size_t charLen = 1;
 
@@ -476,9 +610,22 @@ std::string act_StringChar(std::string const &str, int32_t negIdx) {
 std::string act_CharSub(std::string const &str, int32_t negPos) {
 	warning(WARNING_OBSOLETE, "`CHARSUB` is deprecated; use 0-indexed `STRCHAR` instead");
 
-	size_t adjustLen = act_CharLen(str);
+	std::vector<size_t> const *offsets = charmap_UnitOffsets(str);
+	size_t adjustLen = offsets ? offsets->size() - 1 : convertedLength(str);
 	uint32_t pos = adjustNegativePos(negPos, adjustLen, "CHARSUB");
 
+	if (offsets) {
+		if (pos > adjustLen) {
+			warning(
+			    WARNING_BUILTIN_ARG,
+			    "CHARSUB: Position %" PRIu32 " is past the end of the string",
+			    pos
+			);
+			return "";
+		}
+		return str.substr((*offsets)[pos - 1], (*offsets)[pos] - (*offsets)[pos - 1]);
+	}
+
 	std::string_view view = str;
 	size_t charLen = 1;
 
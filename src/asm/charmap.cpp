@@ -50,9 +50,83 @@ struct CharmapNode {
 	}
 };
 
+// A charmap's trie flattened for `charmap_ConvertNext`, with states numbered like the trie's nodes
+struct CharmapDFA {
+	// Nodes with at least this many children get a dense table of next states
+	static constexpr size_t DENSE_THRESHOLD = 16;
+
+	struct State {
+		uint32_t edgesOfs; // Into `denseEdges` if `isDense`, or else into `sparseEdges`
+		uint32_t nbEdges;  // Only meaningful for sparse states
+		uint32_t valueOfs; // Into `values`
+		uint32_t valueLen; // Nonzero if a mapping ends here
+		bool isDense;
+	};
+
+	std::vector<State> states;
+	std::vector<uint32_t> denseEdges; // 256 next states per dense state, indexed by char
+	std::vector<std::pair<char, uint32_t>> sparseEdges; // Sorted by char per sparse state
+	std::vector<int32_t> values; // All mapped values, pooled
+
+	explicit CharmapDFA(std::vector<CharmapNode> const &nodes) {
+		states.reserve(nodes.size());
+		for (size_t nodeIdx = 0; nodeIdx < nodes.size(); ++nodeIdx) {
+			CharmapNode const &node = nodes[nodeIdx];
+			State &state = states.emplace_back();
+			state.valueOfs = values.size();
+			state.valueLen = node.value.size();
+			values.insert(values.end(), RANGE(node.value));
+			// The root is dense, since every conversion goes through it
+			state.isDense = nodeIdx == 0 || node.children.size() >= DENSE_THRESHOLD;
+			if (state.isDense) {
+				state.edgesOfs = denseEdges.size();
+				state.nbEdges = 0;
+				denseEdges.resize(denseEdges.size() + 256, 0);
+				for (auto const &[c, nextIdx] : node.children) {
+					denseEdges[state.edgesOfs + static_cast<uint8_t>(c)] = nextIdx;
+				}
+			} else {
+				state.edgesOfs = sparseEdges.size();
+				state.nbEdges = node.children.size();
+				for (auto const &[c, nextIdx] : node.children) {
+					sparseEdges.emplace_back(c, nextIdx);
+				}
+			}
+		}
+	}
+
+	uint32_t next(uint32_t stateIdx, char c) const {
+		State const &state = states[stateIdx];
+		if (state.isDense) {
+			return denseEdges[state.edgesOfs + static_cast<uint8_t>(c)];
+		}
+		// Sparse states have few edges, so a linear scan is fastest
+		for (uint32_t i = state.edgesOfs, end = i + state.nbEdges; i < end; ++i) {
+			if (sparseEdges[i].first == c) {
+				return sparseEdges[i].second;
+			} else if (sparseEdges[i].first > c) {
+				break;
+			}
+		}
+		return 0;
+	}
+};
+
 struct Charmap {
 	InternedStr name;
 	std::vector<CharmapNode> nodes; // Trie of mappings (first node is reserved for the root node)
+	// Compiled from `nodes` on first conversion; reset whenever they are modified
+	std::optional<CharmapDFA> dfa = std::nullopt;
+	// Units of the last string indexed by `charmap_UnitOffsets`; reset whenever `nodes` change
+	std::string indexedInput;
+	std::optional<std::vector<size_t>> unitOffsets = std::nullopt;
+
+	CharmapDFA const &getDFA() {
+		if (!dfa) {
+			dfa.emplace(nodes);
+		}
+		return *dfa;
+	}
 
 	size_t nextIndexOrAdd(size_t nodeIdx, char c) {
 		std::vector<std::pair<char, size_t>> &children = nodes[nodeIdx].children;
@@ -190,6 +264,8 @@ void charmap_Add(std::string const &mapping, std::vector<int32_t> &&value) {
 		warning(WARNING_CHARMAP_REDEF, "Overriding charmap mapping");
 	}
 	std::swap(node.value, value);
+	charmap.dfa.reset();
+	charmap.unitOffsets.reset();
 }
 
 static CharmapNode const *charmapEntry(std::string const &mapping) {
@@ -230,46 +306,59 @@ std::vector<int32_t> charmap_Convert(std::string const &input) {
 	return output;
 }
 
-size_t charmap_ConvertNext(std::string_view &input, std::vector<int32_t> *output) {
+// Returns how many chars of the longest mapping which `input` starts with are, and the state where
+// that mapping ends (or 0 chars and state if there is none)
+static std::pair<size_t, uint32_t> longestMatch(CharmapDFA const &dfa, std::string_view input) {
 	// The goal is to match the longest mapping possible.
 	// For that, advance through the trie with each character read.
-	// If that would lead to a dead end, rewind characters until the last match, and output.
-	// If no match, read a UTF-8 codepoint and output that.
-	Charmap const &charmap = *currentCharmap;
-	size_t matchIdx = 0;
+	// If that would lead to a dead end, rewind characters until the last match.
+	uint32_t matchIdx = 0;
 	size_t rewindDistance = 0;
 	size_t inputIdx = 0;
 
-	for (size_t nodeIdx = 0; inputIdx < input.length();) {
-		nodeIdx = charmap.nodes[nodeIdx].nextIndex(input[inputIdx]);
+	for (uint32_t stateIdx = 0; inputIdx < input.length();) {
+		stateIdx = dfa.next(stateIdx, input[inputIdx]);
 
-		if (!nodeIdx) {
+		if (!stateIdx) {
 			break;
 		}
 
 		++inputIdx; // Consume that char
 
-		if (charmap.nodes[nodeIdx].isTerminal()) {
-			matchIdx = nodeIdx; // This node matches, register it
-			rewindDistance = 0; // If no longer match is found, rewind here
+		if (dfa.states[stateIdx].valueLen) {
+			matchIdx = stateIdx; // This state matches, register it
+			rewindDistance = 0;  // If no longer match is found, rewind here
 		} else {
 			++rewindDistance;
 		}
 	}
 
 	// We are at a dead end (either because we reached the end of input, or of the trie),
-	// so rewind up to the last match, and output.
+	// so rewind up to the last match.
 	inputIdx -= rewindDistance; // This will rewind all the way if no match found
+	return {inputIdx, matchIdx};
+}
+
+size_t charmap_ConvertNext(std::string_view &input, std::vector<int32_t> *output) {
+	// Output the longest match, if any.
+	// If no match, read a UTF-8 codepoint and output that.
+	Charmap &charmap = *currentCharmap;
+	CharmapDFA const &dfa = charmap.getDFA();
+	auto [inputIdx, matchIdx] = longestMatch(dfa, input);
 
 	size_t matchLen = 0;
 	if (matchIdx) { // A match was found, use it
-		std::vector<int32_t> const &value = charmap.nodes[matchIdx].value;
+		CharmapDFA::State const &match = dfa.states[matchIdx];
 
 		if (output) {
-			output->insert(output->end(), RANGE(value));
+			output->insert(
+			    output->end(),
+			    dfa.values.begin() + match.valueOfs,
+			    dfa.values.begin() + match.valueOfs + match.valueLen
+			);
 		}
 
-		matchLen = value.size();
+		matchLen = match.valueLen;
 	} else if (inputIdx < input.length()) { // No match found, but there is some input left
 		size_t codepointLen = 0;
 		// This will write the codepoint's value to `output`, little-endian
@@ -311,6 +400,45 @@ size_t charmap_ConvertNext(std::string_view &input, std::vector<int32_t> *output
 	return matchLen;
 }
 
+std::vector<size_t> const *charmap_UnitOffsets(std::string const &input) {
+	Charmap &charmap = *currentCharmap;
+	if (charmap.unitOffsets && charmap.indexedInput == input) {
+		return &*charmap.unitOffsets;
+	}
+
+	// Unmapped characters are only warned about if the charmap has any mappings or is not "main"
+	bool warnsUnmapped = charmap.nodes.size() > 1 || charmap.name != mainCharmapName;
+	CharmapDFA const &dfa = charmap.getDFA();
+	std::vector<size_t> offsets;
+	for (size_t inputIdx = 0; inputIdx < input.length();) {
+		offsets.push_back(inputIdx);
+		if (auto [matchLen, matchIdx] = longestMatch(dfa, std::string_view(input).substr(inputIdx));
+		    matchIdx) {
+			inputIdx += matchLen;
+			continue;
+		} else if (warnsUnmapped) {
+			return nullptr;
+		}
+		// Unmapped units are whole codepoints, like in `charmap_ConvertNext`
+		size_t codepointLen = 0;
+		for (Utf8Decoder decoder; inputIdx + codepointLen < input.length();) {
+			if (decoder.update(input[inputIdx + codepointLen]) == UTF8_REJECT) {
+				return nullptr;
+			}
+			++codepointLen;
+			if (decoder.state == UTF8_ACCEPT) {
+				break;
+			}
+		}
+		inputIdx += codepointLen;
+	}
+	offsets.push_back(input.length());
+
+	charmap.indexedInput = input;
+	charmap.unitOffsets = std::move(offsets);
+	return &*charmap.unitOffsets;
+}
+
 std::string charmap_Reverse(std::vector<int32_t> const &value, bool &unique) {
 	Charmap const &charmap = *currentCharmap;
 	std::string revMapping;
@@ -5,6 +5,7 @@
 
 #include <deque>
 #include <errno.h>
+#include <filesystem>
 #include <inttypes.h>
 #include <memory>
 #include <optional>
@@ -14,6 +15,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -53,11 +58,116 @@ struct Context {
 
 static std::stack<Context> contextStack;
 
+// Loops can create a node for each iteration, so nodes are allocated from a pool of blocks,
+// and freed nodes are reused instead of going back to the heap
+template<typename T>
+class NodePoolAllocator {
+	static constexpr size_t BLOCK_SIZE = 256;
+
+	union Slot {
+		Slot *next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	struct Pool {
+		std::vector<std::unique_ptr<Slot[]>> blocks;
+		size_t nbUsedInLastBlock = BLOCK_SIZE;
+		Slot *freeList = nullptr;
+	};
+
+	// The pool is never destroyed, since nodes may outlive any static object
+	static Pool &pool() {
+		static Pool &pool = *new Pool();
+		return pool;
+	}
+
+public:
+	using value_type = T;
+
+	NodePoolAllocator() = default;
+	template<typename U>
+	NodePoolAllocator(NodePoolAllocator<U> const &) {}
+
+	T *allocate(size_t n) {
+		assume(n == 1);
+		Pool &p = pool();
+		Slot *slot = p.freeList;
+		if (slot) {
+			p.freeList = slot->next;
+		} else {
+			if (p.nbUsedInLastBlock == BLOCK_SIZE) {
+				p.blocks.emplace_back(new Slot[BLOCK_SIZE]);
+				p.nbUsedInLastBlock = 0;
+			}
+			slot = &p.blocks.back()[p.nbUsedInLastBlock++];
+		}
+		return reinterpret_cast<T *>(slot->storage);
+	}
+
+	void deallocate(T *ptr, [[maybe_unused]] size_t n) {
+		assume(n == 1);
+		Pool &p = pool();
+		Slot *slot = reinterpret_cast<Slot *>(ptr);
+		slot->next = p.freeList;
+		p.freeList = slot;
+	}
+
+	template<typename U>
+	bool operator==(NodePoolAllocator<U> const &) const {
+		return true;
+	}
+};
+
+template<typename... ArgsT>
+static std::shared_ptr<FileStackNode> newFileStackNode(ArgsT &&...args) {
+	return std::allocate_shared<FileStackNode>(
+	    NodePoolAllocator<FileStackNode>{}, std::forward<ArgsT>(args)...
+	);
+}
+
 // The first include path for `fstk_FindFile` to try is none at all
 static std::vector<std::string> includePaths = {""}; // -I
 static std::deque<std::string> preIncludeStack;      // -P
+// Results of `fstk_FindFile` for each path, including failures to find it
+static std::unordered_map<std::string, std::optional<std::string>> foundFiles;
+// Names of the entries in each include path, if they have been listed (see `--list-include-dirs`)
+static std::vector<std::optional<std::unordered_set<std::string>>> includeDirEntries;
 static bool failedOnMissingInclude = false;
 
+std::vector<uint32_t> FileStackNode::iters() const {
+	std::vector<uint32_t> nodeIters;
+	for (FileStackNode const *node = this; node->type == NODE_REPT; node = node->parent.get()) {
+		nodeIters.push_back(node->iter());
+	}
+	return nodeIters;
+}
+
+std::string const &FileStackNode::name() const {
+	if (MacroNodeSource const *source = std::get_if<MacroNodeSource>(&data); source) {
+		FileStackNode const &defNode = *source->defNode;
+
+		std::string macroNodeName;
+		for (FileStackNode const *node = &defNode; node; node = node->parent.get()) {
+			if (node->type != NODE_REPT) {
+				macroNodeName.append(node->name());
+				break;
+			}
+		}
+		if (defNode.type == NODE_REPT) {
+			std::vector<uint32_t> defIters = defNode.iters();
+			for (uint32_t iter : reversed(defIters)) {
+				macroNodeName.append(NODE_SEPARATOR REPT_NODE_PREFIX);
+				macroNodeName.append(std::to_string(iter));
+			}
+		}
+		macroNodeName.append(NODE_SEPARATOR);
+		macroNodeName.append(source->macroName.str());
+
+		data = std::move(macroNodeName); // This also releases the reference to `defNode`
+	}
+	return std::get<std::string>(data);
+}
+
 void FileStackNode::printBacktrace(uint32_t curLineNo) const {
 	using TraceItem = std::pair<FileStackNode const *, uint32_t>;
 	std::vector<TraceItem> items;
@@ -84,13 +194,11 @@ void FileStackNode::printBacktrace(uint32_t curLineNo) const {
 	std::vector<TraceNode> traceNodes;
 	traceNodes.reserve(items.size());
 	for (auto &[node, itemLineNo] : reversed(items)) {
-		if (std::holds_alternative<std::vector<uint32_t>>(node->data)) {
+		if (std::holds_alternative<uint32_t>(node->data)) {
 			assume(!traceNodes.empty()); // REPT nodes use their parent's name
 			std::string reptName = traceNodes.back().first;
-			if (std::vector<uint32_t> const &nodeIters = node->iters(); !nodeIters.empty()) {
-				reptName.append(NODE_SEPARATOR REPT_NODE_PREFIX);
-				reptName.append(std::to_string(nodeIters.front()));
-			}
+			reptName.append(NODE_SEPARATOR REPT_NODE_PREFIX);
+			reptName.append(std::to_string(node->iter()));
 			traceNodes.emplace_back(reptName, itemLineNo);
 		} else {
 			traceNodes.emplace_back(node->name(), itemLineNo);
@@ -124,6 +232,10 @@ void fstk_VerboseOutputConfig() {
 			}
 		}
 	}
+	// --list-include-dirs
+	if (options.listIncludeDirs) {
+		fputs("\tList entries of include paths up front\n", stderr);
+	}
 	// -P/--preinclude
 	if (!preIncludeStack.empty()) {
 		fputs("\tPreincluded files:\n", stderr);
@@ -166,6 +278,9 @@ void fstk_AddIncludePath(std::string const &path) {
 	if (includePath.back() != '/') {
 		includePath += '/';
 	}
+	// Paths may be found in the new include path
+	foundFiles.clear();
+	includeDirEntries.clear();
 }
 
 void fstk_AddPreIncludeFile(std::string const &path) {
@@ -184,13 +299,75 @@ static void printDep(std::string const &path) {
 	}
 }
 
-std::optional<std::string> fstk_FindFile(std::string const &path) {
-	for (std::string &incPath : includePaths) {
-		if (std::string fullPath = incPath + path; isValidFilePath(fullPath)) {
-			printDep(fullPath);
+static void listIncludeDirs() {
+	includeDirEntries.clear();
+	for (std::string const &incPath : includePaths) {
+		std::optional<std::unordered_set<std::string>> &entries = includeDirEntries.emplace_back();
+		if (incPath.empty()) {
+			continue; // Do not list the working directory
+		}
+		std::error_code ec;
+		std::filesystem::directory_iterator dir(incPath, ec);
+		if (ec) {
+			continue; // Fall back to checking each path in this directory
+		}
+		entries.emplace();
+		for (; dir != std::filesystem::directory_iterator(); dir.increment(ec)) {
+			entries->insert(dir->path().filename().string());
+		}
+		// LCOV_EXCL_START
+		verbosePrint(
+		    VERB_INFO,
+		    "Listed %zu entries of include path \"%s\"\n",
+		    entries->size(),
+		    incPath.c_str()
+		);
+		// LCOV_EXCL_STOP
+	}
+}
+
+static bool mayBeInIncludeDir(size_t i, std::string const &path) {
+	std::optional<std::unordered_set<std::string>> const &entries = includeDirEntries[i];
+	if (!entries) {
+		return true;
+	}
+#if defined(_MSC_VER) || defined(__MINGW32__)
+	std::string_view name = std::string_view{path}.substr(0, path.find_first_of("/\\"));
+#else
+	std::string_view name = std::string_view{path}.substr(0, path.find('/'));
+#endif
+	// Only check names of entries which are actually in the directory
+	return name.empty() || name == "." || name == ".." || entries->contains(std::string{name});
+}
+
+static std::optional<std::string> findFile(std::string const &path) {
+	if (options.listIncludeDirs && includeDirEntries.size() != includePaths.size()) {
+		listIncludeDirs();
+	}
+
+	for (size_t i = 0; i < includePaths.size(); ++i) {
+		if (options.listIncludeDirs && !mayBeInIncludeDir(i, path)) {
+			continue;
+		}
+		if (std::string fullPath = includePaths[i] + path; isValidFilePath(fullPath)) {
 			return fullPath;
 		}
 	}
+	return std::nullopt;
+}
+
+std::optional<std::string> fstk_FindFile(std::string const &path) {
+	// Files are not expected to appear or disappear during assembly,
+	// so each path only needs to be searched for once
+	auto search = foundFiles.find(path);
+	if (search == foundFiles.end()) {
+		search = foundFiles.emplace(path, findFile(path)).first;
+	}
+
+	if (std::optional<std::string> const &fullPath = search->second; fullPath) {
+		printDep(*fullPath);
+		return fullPath;
+	}
 
 	if (options.missingIncludeState != INC_ERROR) {
 		printDep(path);
@@ -220,14 +397,14 @@ bool yywrap() {
 
 		// If the node is referenced outside this context, we can't edit it, so duplicate it
 		if (context.fileInfo.use_count() > 1) {
-			context.fileInfo = std::make_shared<FileStackNode>(*context.fileInfo);
+			context.fileInfo = newFileStackNode(*context.fileInfo);
 			context.fileInfo->ID = UINT32_MAX; // The copy is not yet registered
 		}
 
-		std::vector<uint32_t> &fileInfoIters = context.fileInfo->iters();
+		uint32_t &fileInfoIter = context.fileInfo->iter();
 
 		// If this is a FOR, update the symbol value
-		if (context.isForLoop && fileInfoIters.front() <= context.nbReptIters) {
+		if (context.isForLoop && fileInfoIter <= context.nbReptIters) {
 			// Avoid arithmetic overflow runtime error
 			uint32_t forValue =
 			    static_cast<uint32_t>(context.forValue) + static_cast<uint32_t>(context.forStep);
@@ -241,9 +418,9 @@ bool yywrap() {
 			}
 		}
 		// Advance to the next iteration
-		++fileInfoIters.front();
+		++fileInfoIter;
 		// If this wasn't the last iteration, wrap instead of popping
-		if (fileInfoIters.front() <= context.nbReptIters) {
+		if (fileInfoIter <= context.nbReptIters) {
 			lexer_RestartRept(context.fileInfo->lineNo);
 			context.uniqueIDStr->clear(); // Invalidate the current unique ID (if any).
 			return false;
@@ -271,7 +448,7 @@ static void newFileContext(std::string const &filePath, bool isQuiet, bool updat
 	std::shared_ptr<MacroArgs> macroArgs = nullptr;
 
 	auto fileInfo =
-	    std::make_shared<FileStackNode>(NODE_FILE, filePath == "-" ? "<stdin>" : filePath, isQuiet);
+	    newFileStackNode(NODE_FILE, filePath == "-" ? "<stdin>" : filePath, isQuiet);
 	if (!contextStack.empty()) {
 		Context &oldContext = contextStack.top();
 		fileInfo->parent = oldContext.fileInfo;
@@ -295,24 +472,10 @@ static void
 
 	Context &oldContext = contextStack.top();
 
-	std::string fileInfoName;
-	for (FileStackNode const *node = macro.src.get(); node; node = node->parent.get()) {
-		if (node->type != NODE_REPT) {
-			fileInfoName.append(node->name());
-			break;
-		}
-	}
-	if (macro.src->type == NODE_REPT) {
-		std::vector<uint32_t> const &srcIters = macro.src->iters();
-		for (uint32_t iter : reversed(srcIters)) {
-			fileInfoName.append(NODE_SEPARATOR REPT_NODE_PREFIX);
-			fileInfoName.append(std::to_string(iter));
-		}
-	}
-	fileInfoName.append(NODE_SEPARATOR);
-	fileInfoName.append(macro.name.str());
-
-	auto fileInfo = std::make_shared<FileStackNode>(NODE_MACRO, fileInfoName, isQuiet);
+	// The name is only built if the node is ever printed or output
+	auto fileInfo = newFileStackNode(
+	    NODE_MACRO, MacroNodeSource{.defNode = macro.src, .macroName = macro.name}, isQuiet
+	);
 	assume(!contextStack.empty()); // The top level context cannot be a MACRO
 	fileInfo->parent = oldContext.fileInfo;
 	fileInfo->lineNo = lexer_GetLineNo();
@@ -332,13 +495,8 @@ static Context &
 
 	Context &oldContext = contextStack.top();
 
-	std::vector<uint32_t> fileInfoIters{1};
-	if (oldContext.fileInfo->type == NODE_REPT && !oldContext.fileInfo->iters().empty()) {
-		// Append all parent iter counts
-		fileInfoIters.insert(fileInfoIters.end(), RANGE(oldContext.fileInfo->iters()));
-	}
-
-	auto fileInfo = std::make_shared<FileStackNode>(NODE_REPT, fileInfoIters, isQuiet);
+	// Parent iter counts are not copied, since they are kept by the parent nodes
+	auto fileInfo = newFileStackNode(NODE_REPT, uint32_t{1}, isQuiet);
 	assume(!contextStack.empty()); // The top level context cannot be a REPT
 	fileInfo->parent = oldContext.fileInfo;
 	fileInfo->lineNo = reptLineNo;
@@ -350,6 +508,10 @@ static Context &
 	});
 
 	context.lexerState.setViewAsNextState("REPT", span, reptLineNo);
+	if (count > 1) {
+		// Later iterations can replay the tokens lexed by the first one
+		context.lexerState.enableTokenCache();
+	}
 
 	context.nbReptIters = count;
 
@@ -392,23 +554,24 @@ bool fstk_RunInclude(std::string const &path, bool isQuiet) {
 
 void fstk_RunMacro(InternedStr macroName, std::shared_ptr<MacroArgs> macroArgs, bool isQuiet) {
 	auto makeSuggestion = [&macroName, &macroArgs]() -> std::optional<std::string> {
-		std::shared_ptr<std::string> arg = macroArgs->getArg(1);
+		std::optional<std::string_view> arg = macroArgs->getArg(1);
 		if (!arg) {
 			return std::nullopt;
 		}
 
-		char const *str = arg->c_str();
+		std::string firstArg{*arg};
+		char const *str = firstArg.c_str();
 		static char const *types[] = {"EQUS", "EQU", "RB", "RW", "RL", "="};
 		for (char const *type : types) {
 			if (strncasecmp(str, type, strlen(type)) == 0) {
-				return "\"DEF "s + macroName.str() + " " + type + " ...\"";
+				return "\"DEF "s + macroName.c_str() + " " + type + " ...\"";
 			}
 		}
 		if (strncasecmp(str, "SET", literal_strlen("SET")) == 0) {
-			return "\"DEF "s + macroName.str() + " = ...\"";
+			return "\"DEF "s + macroName.c_str() + " = ...\"";
 		}
 		if (str[0] == ':') {
-			return "a label \""s + macroName.str() + (str[1] == ':' ? "::" : ":") + "\"";
+			return "a label \""s + macroName.c_str() + (str[1] == ':' ? "::" : ":") + "\"";
 		}
 
 		return std::nullopt;
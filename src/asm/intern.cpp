@@ -2,44 +2,116 @@
 
 #include "asm/intern.hpp"
 
-#include <deque>
-#include <functional> // equal_to
+#include <algorithm>
+#include <memory>
+#include <new>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <utility> // swap
+#include <vector>
 
 #include "helpers.hpp" // assume
 #include "verbosity.hpp"
 
-// Avoid `std::string` allocations when looking up heterogeneous values in `internedIndexes`
-struct StringHash {
-	using is_transparent = void;
+// Interned strings are never freed, so they are allocated one after another in large blocks
+static constexpr size_t ARENA_BLOCK_SIZE = 0x10000;
+static std::vector<std::unique_ptr<char[]>> arenaBlocks;
+static char *arenaPtr = nullptr;
+static size_t arenaRemaining = 0;
 
-	size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+static char *allocInterned(std::string_view str, size_t index) {
+	size_t length = str.length();
+	// Keep each header aligned, and room for the NUL terminator
+	size_t size = sizeof(InternedHeader) + length + 1;
+	size = (size + alignof(InternedHeader) - 1) & ~(alignof(InternedHeader) - 1);
+
+	if (size > arenaRemaining) {
+		size_t blockSize = std::max(size, ARENA_BLOCK_SIZE);
+		arenaPtr = arenaBlocks.emplace_back(new char[blockSize]).get();
+		arenaRemaining = blockSize;
+	}
+
+	size_t dotPos = str.find('.');
+	InternedHeader *header = new (arenaPtr) InternedHeader{
+	    .index = index,
+	    .length = length,
+	    .dotPos = dotPos,
+	    .hasNestedDot = dotPos != str.npos && str.find('.', dotPos + 1) != str.npos,
+	};
+	arenaPtr += size;
+	arenaRemaining -= size;
+	return reinterpret_cast<char *>(header + 1);
+}
+
+// An open-addressing hash table of all interned strings, with linear probing
+struct InternedSlot {
+	size_t hash;
+	size_t length;
+	char const *chars; // `nullptr` if the slot is empty
 };
 
-// Use a `deque` not a `vector` to prevent reallocation so `internedIndexes` keys stay valid
-static std::deque<std::string> internedStrings;
-// Keys are views of values in `internedStrings`; values are their corresponding indexes
-static std::unordered_map<std::string_view, size_t, StringHash, std::equal_to<>> internedIndexes;
+static std::vector<InternedSlot> internedSlots(0x400);
+static size_t nbInterned = 0;
+
+static InternedSlot &findSlot(std::string_view str, size_t hash) {
+	size_t mask = internedSlots.size() - 1;
+	for (size_t i = hash & mask;; i = (i + 1) & mask) {
+		if (InternedSlot &slot = internedSlots[i];
+		    !slot.chars
+		    || (slot.hash == hash && slot.length == str.length()
+		        && memcmp(slot.chars, str.data(), str.length()) == 0)) {
+			return slot;
+		}
+	}
+}
 
-std::string const &InternedStr::str() const {
-	assume(index != static_cast<size_t>(-1));
-	return internedStrings[index];
+static void growSlots() {
+	std::vector<InternedSlot> oldSlots(internedSlots.size() * 2);
+	std::swap(internedSlots, oldSlots);
+	for (InternedSlot const &slot : oldSlots) {
+		if (slot.chars) {
+			findSlot(std::string_view{slot.chars, slot.length}, slot.hash) = slot;
+		}
+	}
 }
 
 InternedStr intern(std::string_view str) {
-	if (auto search = internedIndexes.find(str); search != internedIndexes.end()) {
-		return InternedStr(search->second);
+	size_t hash = std::hash<std::string_view>{}(str);
+	if (InternedSlot const &slot = findSlot(str, hash); slot.chars) {
+		return InternedStr(slot.chars);
+	}
+
+	// Keep the table at most 3/4 full so that probe sequences stay short
+	if ((nbInterned + 1) * 4 > internedSlots.size() * 3) {
+		growSlots();
 	}
 
-	size_t index = internedStrings.size();
-	std::string &interned = internedStrings.emplace_back(str);
-	internedIndexes.emplace(interned, index);
+	char *chars = allocInterned(str, nbInterned++);
+	memcpy(chars, str.data(), str.length());
+	chars[str.length()] = '\0';
+	findSlot(str, hash) = {.hash = hash, .length = str.length(), .chars = chars};
+
+	verbosePrint(VERB_TRACE, "Interned string \"%s\"\n", chars);
 
-	verbosePrint(VERB_TRACE, "Interned string \"%s\"\n", interned.c_str());
+	return InternedStr(chars);
+}
+
+// Names of anonymous labels which were needed, indexed by ID; not in the table, so they do not
+// make it grow, nor can they be found by `intern`
+static std::vector<char const *> anonLabelNames;
 
-	return InternedStr(index);
+char const *anonLabelChars(uint32_t id) {
+	if (id >= anonLabelNames.size()) {
+		anonLabelNames.resize(id + 1, nullptr);
+	}
+	if (!anonLabelNames[id]) {
+		std::string name = "!" + std::to_string(id);
+		char *chars = allocInterned(name, SIZE_MAX);
+		memcpy(chars, name.data(), name.length() + 1);
+		anonLabelNames[id] = chars;
+	}
+	return anonLabelNames[id];
 }
@@ -20,6 +20,7 @@
 #include <string.h>
 #include <string>
 #include <string_view>
+#include <time.h>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -73,7 +74,7 @@ struct Token {
 
 // This map lists all RGBASM keywords which `yylex_NORMAL` lexes as identifiers.
 // All non-identifier tokens are lexed separately.
-static UpperMap<int> const keywords{
+static KeywordMap<int> const keywords{
     {"ADC",           T_(SM83_ADC)         },
     {"ADD",           T_(SM83_ADD)         },
     {"AND",           T_(SM83_AND)         },
@@ -277,6 +278,43 @@ static UpperMap<int> const keywords{
 static LexerState *lexerState = nullptr;
 static LexerState *lexerStateEOL = nullptr;
 
+// A token lexed from a loop body, which can be replayed instead of lexing the same text again
+struct CachedToken {
+	Token token;
+	size_t endOffset;             // Value of `lexerState->offset` after lexing the token
+	uint32_t lineNo;              // Value of `lexerState->lineNo` after lexing the token
+	size_t expansionScanDistance; // Value of `lexerState->expansionScanDistance` likewise
+	bool mayExpand;               // Whether the token would be expanded if it were an `EQUS`
+};
+
+struct TokenCache {
+	// Options which affect how numbers are lexed; the cache is reset if they change
+	char binDigits[2];
+	char gfxDigits[4];
+	uint8_t fixPrecision;
+
+	std::unordered_map<size_t, CachedToken> tokens; // Keys are offsets where the tokens start
+
+	bool matchesOptions() const {
+		return !memcmp(binDigits, options.binDigits, sizeof(binDigits))
+		       && !memcmp(gfxDigits, options.gfxDigits, sizeof(gfxDigits))
+		       && fixPrecision == options.fixPrecision;
+	}
+
+	void reset() {
+		memcpy(binDigits, options.binDigits, sizeof(binDigits));
+		memcpy(gfxDigits, options.gfxDigits, sizeof(gfxDigits));
+		fixPrecision = options.fixPrecision;
+		tokens.clear();
+	}
+};
+
+// Cleared by anything that makes the token being lexed differ between loop iterations,
+// e.g. expansions or anonymous label references
+static bool tokenIsCacheable;
+// Set when the token being lexed is an identifier which was checked for `EQUS` expansion
+static bool tokenMayExpand;
+
 bool lexer_AtTopLevel() {
 	return lexerState == nullptr;
 }
@@ -298,6 +336,9 @@ void LexerState::clear(uint32_t lineNo_) {
 
 	expansionStack.clear();
 
+	nextExpansionIdx = 0;
+	expansionFreeEnd = 0;
+
 	lineNo = lineNo_; // Will be incremented at next line start
 }
 
@@ -344,6 +385,168 @@ void LexerState::setAsCurrentState() {
 	lexerState = this;
 }
 
+// Leading keywords of a source file, indexed so that skipping and capturing blocks can jump
+// from one to the next without scanning the lines in between
+struct KeywordIndex {
+	struct Entry {
+		size_t lineStart;  // Offset of the start of the keyword's line
+		size_t keywordEnd; // Offset right after the keyword
+		int type;          // Token type of the keyword
+	};
+
+	bool built = false;
+	std::vector<size_t> lineStarts; // Offsets right after each newline
+	std::vector<Entry> entries;
+
+	void build(ContentSpan const &content);
+	size_t nbNewlinesBefore(size_t offset) const {
+		return std::upper_bound(RANGE(lineStarts), offset) - lineStarts.begin();
+	}
+};
+
+// Files which have already been loaded, so that repeated `INCLUDE`s and `INCBIN`s can share their
+// contents
+struct CachedFile {
+	dev_t device;
+	ino_t inode;
+	off_t size;
+	time_t modTime;
+	ContentSpan content;
+
+	bool matches(struct stat const &statBuf) const {
+		return device == statBuf.st_dev && inode == statBuf.st_ino && size == statBuf.st_size
+		       && modTime == statBuf.st_mtime;
+	}
+};
+
+static std::unordered_map<std::string, CachedFile> fileCache; // Keys are file paths
+
+static size_t nbBytesMapped = 0; // Total size of files loaded with `mmap`
+static size_t nbBytesRead = 0;   // Total size of files loaded with `read`
+static size_t nbBytesReused = 0; // Total size of files loaded from `fileCache`
+
+static uint64_t nbTokensLexed = 0;      // Total number of tokens returned by `yylex`
+static uint64_t nbIdentifiersBuilt = 0; // Identifiers that could not be viewed in place
+
+static uint64_t nbInterpolationsFormatted = 0; // Interpolations formatted from their symbol
+static uint64_t nbInterpolationsReused = 0;    // Interpolations reused from `interpolationCache`
+
+#if HAVE_MMAP
+static ContentSpan mapFile(std::string const &path, size_t size) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return {.ptr = nullptr, .size = 0}; // LCOV_EXCL_LINE
+	}
+	void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	xclose(fd); // The mapping stays valid after the file descriptor is closed
+	if (mapping == MAP_FAILED) {
+		return {.ptr = nullptr, .size = 0}; // LCOV_EXCL_LINE
+	}
+	// The mapping is unmapped once the last span referring to it is released
+	return {
+	    .ptr = std::shared_ptr<char[]>(
+	        static_cast<char *>(mapping), [size](char *ptr) { munmap(ptr, size); }
+	    ),
+	    .size = size,
+	};
+}
+#endif
+
+// Returns `std::nullopt` if the file cannot be read, leaving the caller to report it
+static std::optional<ContentSpan> readFile(std::string const &path, std::streamsize size) {
+	// Ideally we'd use C++20 `std::make_shared<char[]>(size)`,
+	// but it has insufficient compiler support
+	ContentSpan content = {
+	    .ptr = std::shared_ptr<char[]>(new char[size]), .size = static_cast<size_t>(size)
+	};
+
+	if (std::ifstream fs(path, std::ios::binary);
+	    !fs || !fs.read(content.ptr.get(), size) || fs.gcount() != size) {
+		return std::nullopt; // LCOV_EXCL_LINE
+	}
+
+	return content;
+}
+
+static std::optional<ContentSpan> loadFile(std::string const &path, struct stat const &statBuf) {
+	if (auto search = fileCache.find(path);
+	    search != fileCache.end() && search->second.matches(statBuf)) {
+		nbBytesReused += search->second.content.size;
+		verbosePrint(VERB_INFO, "File \"%s\" is already loaded\n", path.c_str()); // LCOV_EXCL_LINE
+		return search->second.content;
+	}
+
+	ContentSpan content = {.ptr = nullptr, .size = 0};
+#if HAVE_MMAP
+	// Map the entire file for better performance
+	content = mapFile(path, static_cast<size_t>(statBuf.st_size));
+	if (content.ptr) {
+		nbBytesMapped += content.size;
+		verbosePrint(VERB_INFO, "File \"%s\" is mapped\n", path.c_str()); // LCOV_EXCL_LINE
+	}
+#endif
+	if (!content.ptr) {
+		// Read the entire file for better performance
+		std::optional<ContentSpan> fileContent = readFile(path, statBuf.st_size);
+		if (!fileContent) {
+			return std::nullopt; // LCOV_EXCL_LINE
+		}
+		content = std::move(*fileContent);
+		nbBytesRead += content.size;
+		verbosePrint(VERB_INFO, "File \"%s\" is fully read\n", path.c_str()); // LCOV_EXCL_LINE
+	}
+	content.keywordIndex = std::make_shared<KeywordIndex>();
+
+	fileCache.insert_or_assign(
+	    path,
+	    CachedFile{
+	        .device = statBuf.st_dev,
+	        .inode = statBuf.st_ino,
+	        .size = statBuf.st_size,
+	        .modTime = statBuf.st_mtime,
+	        .content = content,
+	    }
+	);
+	return content;
+}
+
+std::optional<ContentSpan> lexer_LoadFile(std::string const &path) {
+	struct stat statBuf;
+	// Only regular files can be mapped or measured; others have to be read as a stream
+	if (stat(path.c_str(), &statBuf) != 0 || !S_ISREG(statBuf.st_mode)) {
+		return std::nullopt;
+	}
+	if (statBuf.st_size == 0) {
+		return ContentSpan{.ptr = nullptr, .size = 0};
+	}
+	return loadFile(path, statBuf);
+}
+
+// LCOV_EXCL_START
+void lexer_VerboseOutputStats() {
+	assume(checkVerbosity(VERB_INFO));
+	fprintf(
+	    stderr,
+	    "Files: %zu bytes mapped, %zu bytes read, %zu bytes reused\n",
+	    nbBytesMapped,
+	    nbBytesRead,
+	    nbBytesReused
+	);
+	fprintf(
+	    stderr,
+	    "Lexed %" PRIu64 " tokens, %" PRIu64 " identifiers built outside the source\n",
+	    nbTokensLexed,
+	    nbIdentifiersBuilt
+	);
+	fprintf(
+	    stderr,
+	    "Interpolations: %" PRIu64 " formatted, %" PRIu64 " reused\n",
+	    nbInterpolationsFormatted,
+	    nbInterpolationsReused
+	);
+}
+// LCOV_EXCL_STOP
+
 void LexerState::setFileAsNextState(std::string const &filePath, bool updateStateNow) {
 	int fd = -1;
 
@@ -360,26 +563,14 @@ void LexerState::setFileAsNextState(std::string const &filePath, bool updateStat
 		}
 		path = filePath;
 
-		if (std::streamsize size = statBuf.st_size; statBuf.st_size > 0) {
-			// Read the entire file for better performance
-			// Ideally we'd use C++20 `content.ptr = std::make_shared<char[]>(size)`,
-			// but it has insufficient compiler support
-			content.ptr = std::shared_ptr<char[]>(new char[size]);
-			content.size = static_cast<size_t>(size);
-
-			if (std::ifstream fs(path, std::ios::binary); !fs) {
-				// LCOV_EXCL_START
-				fatal("Failed to open file \"%s\": %s", path.c_str(), strerror(errno));
-				// LCOV_EXCL_STOP
-			} else if (!fs.read(content.ptr.get(), size) || fs.gcount() != size) {
+		if (statBuf.st_size > 0) {
+			std::optional<ContentSpan> fileContent = loadFile(path, statBuf);
+			if (!fileContent) {
 				// LCOV_EXCL_START
 				fatal("Failed to read file \"%s\": %s", path.c_str(), strerror(errno));
 				// LCOV_EXCL_STOP
 			}
-
-			// LCOV_EXCL_START
-			verbosePrint(VERB_INFO, "File \"%s\" is fully read\n", path.c_str());
-			// LCOV_EXCL_STOP
+			content = std::move(*fileContent);
 		} else {
 			// LCOV_EXCL_START
 			if (statBuf.st_size == 0) {
@@ -432,6 +623,7 @@ void LexerState::setFileAsNextState(std::string const &filePath, bool updateStat
 		}
 		content.ptr = std::shared_ptr<char[]>(vec, vec->data());
 		content.size = vec->size();
+		nbBytesRead += content.size;
 
 		verbosePrint(VERB_INFO, "File \"%s\" is fully read\n", path.c_str()); // LCOV_EXCL_LINE
 	}
@@ -455,6 +647,11 @@ void LexerState::setViewAsNextState(
 	lexerStateEOL = this;
 }
 
+void LexerState::enableTokenCache() {
+	tokenCache = std::make_shared<TokenCache>();
+	tokenCache->reset();
+}
+
 void lexer_RestartRept(uint32_t lineNo) {
 	lexerState->offset = 0;
 	lexerState->clear(lineNo);
@@ -490,17 +687,28 @@ void lexer_ToggleStringExpansion(bool enable) {
 
 // Functions for the actual lexer to obtain characters
 
-static void beginExpansion(std::shared_ptr<std::string> str, std::optional<InternedStr> name) {
+static void beginExpansion(
+    std::shared_ptr<std::string> owner, std::string_view str, std::optional<InternedStr> name
+) {
+	tokenIsCacheable = false;
+
 	if (name) {
 		lexer_CheckRecursionDepth();
 	}
 
 	// Do not expand empty strings
-	if (str->empty()) {
+	if (str.empty()) {
 		return;
 	}
 
-	lexerState->expansionStack.push_front({.name = name, .contents = str, .offset = 0});
+	lexerState->expansionStack.push_front(
+	    {.name = name, .owner = std::move(owner), .contents = str, .offset = 0}
+	);
+}
+
+static void beginExpansion(std::shared_ptr<std::string> str, std::optional<InternedStr> name) {
+	std::string_view contents{*str};
+	beginExpansion(std::move(str), contents, name);
 }
 
 void lexer_CheckRecursionDepth() {
@@ -599,52 +807,61 @@ static uint32_t readBracketedMacroArgNum() {
 	}
 }
 
-static std::shared_ptr<std::string> readMacroArg() {
+// The text of a macro arg, along with the buffer that keeps it alive
+struct MacroArgText {
+	std::shared_ptr<std::string> owner;
+	std::string_view text;
+};
+
+static std::optional<MacroArgText> readMacroArg() {
+	tokenIsCacheable = false;
+
 	if (int c = bumpChar(); c == '@') {
 		std::shared_ptr<std::string> str = fstk_GetUniqueIDStr();
 		if (!str) {
 			error("`\\@` cannot be used outside of a macro or loop (`REPT`/`FOR` block)");
+			return std::nullopt;
 		}
-		return str;
+		return MacroArgText{.owner = str, .text = *str};
 	} else if (MacroArgs const *macroArgs = fstk_GetCurrentMacroArgs(); c == '#') {
 		if (!macroArgs) {
 			error("`\\#` cannot be used outside of a macro");
-			return nullptr;
+			return std::nullopt;
 		}
 
-		std::shared_ptr<std::string> str = macroArgs->getAllArgs();
-		assume(str); // '\#' should always be defined (at least as an empty string)
-		return str;
+		return MacroArgText{.owner = macroArgs->buffer, .text = macroArgs->getAllArgs()};
 	} else if (c == '<') {
 		int32_t num = readBracketedMacroArgNum();
 		if (num == 0) {
 			// The error was already reported by `readBracketedMacroArgNum`.
-			return nullptr;
+			return std::nullopt;
 		}
 
 		if (!macroArgs) {
 			error("`\\<%" PRIu32 ">` cannot be used outside of a macro", num);
-			return nullptr;
+			return std::nullopt;
 		}
 
-		std::shared_ptr<std::string> str = macroArgs->getArg(num);
-		if (!str) {
+		std::optional<std::string_view> arg = macroArgs->getArg(num);
+		if (!arg) {
 			error("Macro argument `\\<%" PRId32 ">` not defined", num);
+			return std::nullopt;
 		}
-		return str;
+		return MacroArgText{.owner = macroArgs->buffer, .text = *arg};
 	} else {
 		assume(c >= '1' && c <= '9');
 
 		if (!macroArgs) {
 			error("`\\%c` cannot be used outside of a macro", c);
-			return nullptr;
+			return std::nullopt;
 		}
 
-		std::shared_ptr<std::string> str = macroArgs->getArg(c - '0');
-		if (!str) {
+		std::optional<std::string_view> arg = macroArgs->getArg(c - '0');
+		if (!arg) {
 			error("Macro argument `\\%c` not defined", c);
+			return std::nullopt;
 		}
-		return str;
+		return MacroArgText{.owner = macroArgs->buffer, .text = *arg};
 	}
 }
 
@@ -652,7 +869,7 @@ int LexerState::peekChar() {
 	// This is `.peekCharAhead()` modified for zero lookahead distance
 	for (Expansion const &exp : expansionStack) {
 		if (exp.offset < exp.size()) {
-			return static_cast<uint8_t>((*exp.contents)[exp.offset]);
+			return static_cast<uint8_t>(exp.contents[exp.offset]);
 		}
 	}
 
@@ -675,7 +892,7 @@ int LexerState::peekCharAhead() {
 		if (size_t idx = exp.offset + distance; idx < exp.size()) {
 			// Macro args can't be recursive, since `peek()` marks them as scanned, so
 			// this is a failsafe that (as far as I can tell) won't ever actually run.
-			return static_cast<uint8_t>((*exp.contents)[idx]); // LCOV_EXCL_LINE
+			return static_cast<uint8_t>(exp.contents[idx]); // LCOV_EXCL_LINE
 		}
 		distance -= exp.size() - exp.offset;
 	}
@@ -688,10 +905,38 @@ int LexerState::peekCharAhead() {
 	return EOF;
 }
 
+void LexerState::updateExpansionFreeEnd() {
+	assume(content.expansionOffsets != nullptr);
+
+	std::vector<size_t> const &expansionOffsets = *content.expansionOffsets;
+	while (nextExpansionIdx < expansionOffsets.size()
+	       && expansionOffsets[nextExpansionIdx] < offset) {
+		++nextExpansionIdx;
+	}
+	expansionFreeEnd = nextExpansionIdx < expansionOffsets.size()
+	                       ? expansionOffsets[nextExpansionIdx]
+	                       : content.size;
+}
+
 // Forward declarations for `peek`
 static std::pair<Symbol const *, std::shared_ptr<std::string>> readInterpolation(size_t depth);
 
 static int peek() {
+	// Only captured bodies know where expansions may begin; files always take the checks below
+	if (lexerState->expansionStack.empty() && lexerState->content.expansionOffsets) {
+		if (lexerState->offset >= lexerState->expansionFreeEnd) {
+			lexerState->updateExpansionFreeEnd();
+		}
+		// Optimize the common case (no possible expansions until `expansionFreeEnd`)
+		// to skip checking for a backslash or brace
+		if (lexerState->offset < lexerState->expansionFreeEnd) {
+			if (lexerState->expansionScanDistance == 0) {
+				++lexerState->expansionScanDistance;
+			}
+			return static_cast<uint8_t>(lexerState->content.ptr[lexerState->offset]);
+		}
+	}
+
 	for (;;) {
 		int c = lexerState->peekChar();
 
@@ -711,13 +956,13 @@ static int peek() {
 			}
 			// If character is a macro arg char, do macro arg expansion
 			shiftChar();
-			if (std::shared_ptr<std::string> str = readMacroArg(); str) {
-				beginExpansion(str, std::nullopt);
+			if (std::optional<MacroArgText> arg = readMacroArg(); arg) {
+				beginExpansion(std::move(arg->owner), arg->text, std::nullopt);
 
 				// Mark the entire macro arg expansion as "painted blue"
 				// so that macro args can't be recursive
 				// https://en.wikipedia.org/wiki/Painted_blue
-				lexerState->expansionScanDistance += str->length();
+				lexerState->expansionScanDistance += arg->text.length();
 			}
 			// Continue in the next iteration
 		} else if (c == '{') {
@@ -901,6 +1146,9 @@ static void discardLineContinuation() {
 static InternedStr readAnonLabelRef(char c) {
 	assume(c == '+' || c == '-');
 
+	// Anonymous label references depend on how many anonymous labels have been defined
+	tokenIsCacheable = false;
+
 	// We come here having already peeked at one char, so no need to do it again
 	uint32_t n = 1;
 	while (nextChar() == c) {
@@ -1177,36 +1425,65 @@ static uint32_t readGfxConstant() {
 static Token readIdentifier(char firstChar, bool raw) {
 	assume(startsIdentifier(firstChar));
 
-	std::string builder(1, firstChar);
+	// Identifiers are usually contiguous in the content, without any expansions,
+	// so they can be viewed in place instead of being built char by char
+	char const *content = lexerState->content.ptr.get();
+	size_t start = lexerState->offset - 1;
+	bool inPlace = lexerState->expansionStack.empty() && lexerState->offset > 0
+	               && lexerState->offset <= lexerState->content.size
+	               && content[start] == firstChar;
+	size_t length = 1;
+	std::string builder;
+	if (!inPlace) {
+		builder = firstChar;
+	}
+	auto identifier = [&]() {
+		return inPlace ? std::string_view{&content[start], length} : std::string_view{builder};
+	};
+
 	bool keywordBeforeLocal = false;
 	int tokenType = firstChar == '.' ? T_(LOCAL) : T_(SYMBOL);
 
 	// Continue reading while the char is in the identifier charset
 	for (int c = peek(); continuesIdentifier(c); c = nextChar()) {
+		if (inPlace
+		    && (!lexerState->expansionStack.empty() || lexerState->offset != start + length)) {
+			// An expansion interrupted the identifier, so it has to be built after all
+			builder = identifier();
+			inPlace = false;
+		}
+
 		// If the char was a dot, the identifier is a local label
 		if (c == '.') {
 			// Check for a keyword before a non-raw local label
-			if (!raw && tokenType != T_(LOCAL) && keywords.find(builder) != keywords.end()) {
+			if (!raw && tokenType != T_(LOCAL) && keywords.find(identifier())) {
 				keywordBeforeLocal = true;
 			}
 
 			tokenType = T_(LOCAL);
 		}
 
-		builder += c;
+		if (inPlace) {
+			++length;
+		} else {
+			builder += c;
+		}
+	}
+	if (!inPlace) {
+		++nbIdentifiersBuilt;
 	}
 
 	// Check for a keyword if the identifier is not raw and not a local label
 	if (!raw && tokenType != T_(LOCAL)) {
-		if (auto search = keywords.find(builder); search != keywords.end()) {
-			return Token(search->second);
+		if (int const *type = keywords.find(identifier()); type) {
+			return Token(*type);
 		}
 	}
 
-	InternedStr identifier = intern(builder);
+	InternedStr interned = intern(identifier());
 
 	// Label scopes `.` and `..` are the only nonlocal identifiers that start with a dot
-	if (sym_IsDotScope(identifier)) {
+	if (sym_IsDotScope(interned)) {
 		tokenType = T_(SYMBOL);
 	}
 
@@ -1214,21 +1491,90 @@ static Token readIdentifier(char firstChar, bool raw) {
 	if (keywordBeforeLocal) {
 		error(
 		    "Identifier \"%s\" begins with a keyword; did you mean to put a space between them?",
-		    identifier.c_str()
+		    interned.c_str()
 		);
 	}
 
-	return Token(tokenType, identifier);
+	return Token(tokenType, interned);
 }
 
 // Functions to read strings
 
+// A formatted interpolation, reusable as long as its symbol still has the same value
+struct CachedInterpolation {
+	Symbol const *sym = nullptr;
+	std::string spec;
+	uint8_t fixPrecision; // Default precision of `f` formats
+	std::variant<int32_t, std::shared_ptr<std::string>> value;
+	std::shared_ptr<std::string> expansion;
+};
+
+// Direct-mapped by symbol and format spec; small, since the same few interpolations tend to
+// be repeated within one loop iteration or macro body
+static CachedInterpolation interpolationCache[64];
+
+static std::shared_ptr<std::string>
+    formatInterpolation(Symbol const &sym, FormatSpec const &fmt, std::string const &spec) {
+	// Only `EQU`, `=` and `EQUS` values can be cached; builtin callbacks may change at any time,
+	// and labels may not even be constant
+	std::variant<int32_t, std::shared_ptr<std::string>> value;
+	if (auto const *number = std::get_if<int32_t>(&sym.data);
+	    number && (sym.type == SYM_EQU || sym.type == SYM_VAR)) {
+		value = *number;
+	} else if (auto const *str = std::get_if<std::shared_ptr<std::string>>(&sym.data); str) {
+		value = *str;
+	} else {
+		++nbInterpolationsFormatted;
+		auto buf = std::make_shared<std::string>();
+		if (sym.type == SYM_EQUS) {
+			fmt.appendString(*buf, *sym.getEqus());
+		} else {
+			fmt.appendNumber(*buf, sym.getConstantValue());
+		}
+		return buf;
+	}
+
+	CachedInterpolation &entry = interpolationCache
+	    [(std::hash<Symbol const *>{}(&sym) ^ std::hash<std::string>{}(spec) * 31)
+	     % std::size(interpolationCache)];
+	// Comparing the value itself (and not a version of the symbol) also catches redefinitions
+	// after a `PURGE`, or a different symbol reusing the same address
+	if (entry.sym == &sym && entry.spec == spec && entry.fixPrecision == options.fixPrecision
+	    && entry.value == value) {
+		++nbInterpolationsReused;
+		return entry.expansion;
+	}
+
+	++nbInterpolationsFormatted;
+	auto buf = std::make_shared<std::string>();
+	uint64_t startDiagnostics = nbDiagnostics;
+	if (auto const *number = std::get_if<int32_t>(&value); number) {
+		fmt.appendNumber(*buf, *number);
+	} else {
+		fmt.appendString(*buf, *std::get<std::shared_ptr<std::string>>(value));
+	}
+	// Do not cache formats which report diagnostics, so that they are reported every time
+	if (nbDiagnostics == startDiagnostics) {
+		entry = {
+		    .sym = &sym,
+		    .spec = spec,
+		    .fixPrecision = options.fixPrecision,
+		    .value = std::move(value),
+		    .expansion = buf,
+		};
+	}
+	return buf;
+}
+
 static std::pair<Symbol const *, std::shared_ptr<std::string>> readInterpolation(size_t depth) {
+	tokenIsCacheable = false;
+
 	if (depth > options.maxRecursionDepth) {
 		fatal("Recursion limit (%zu) exceeded", options.maxRecursionDepth);
 	}
 
 	std::string builder;
+	std::string spec;
 	FormatSpec fmt{};
 	bool invalid = false;
 
@@ -1254,6 +1600,7 @@ static std::pair<Symbol const *, std::shared_ptr<std::string>> readInterpolation
 				error("Invalid interpolation format spec \"%s\"", builder.c_str());
 				invalid = true;
 			}
+			spec = std::move(builder);
 			builder.clear(); // Now that format has been set, restart at beginning of string.
 		} else {
 			shiftChar();
@@ -1268,7 +1615,7 @@ static std::pair<Symbol const *, std::shared_ptr<std::string>> readInterpolation
 	if (builder.starts_with('#')) {
 		// Skip a '#' raw symbol prefix, but after expanding any nested interpolations.
 		builder.erase(0, 1);
-	} else if (keywords.find(builder) != keywords.end()) {
+	} else if (keywords.find(builder)) {
 		// Don't allow symbols that alias keywords without a '#' prefix.
 		error(
 		    "Interpolated symbol `%s` is a reserved keyword; add a '#' prefix to use it as a raw "
@@ -1287,21 +1634,15 @@ static std::pair<Symbol const *, std::shared_ptr<std::string>> readInterpolation
 			error("Interpolated symbol `%s` does not exist", symName.c_str());
 		}
 		return {sym, nullptr};
-	} else if (sym->type == SYM_EQUS) {
-		auto buf = std::make_shared<std::string>();
-		fmt.appendString(*buf, *sym->getEqus());
-		return {sym, buf};
-	} else if (sym->isNumeric()) {
-		auto buf = std::make_shared<std::string>();
-		fmt.appendNumber(*buf, sym->getConstantValue());
-		return {sym, buf};
+	} else if (sym->type == SYM_EQUS || sym->isNumeric()) {
+		return {sym, formatInterpolation(*sym, fmt, spec)};
 	} else {
 		error("Interpolated symbol `%s` is not a numeric or string symbol", symName.c_str());
 		return {sym, nullptr};
 	}
 }
 
-static void appendExpandedString(std::string &str, std::string const &expanded) {
+static void appendExpandedString(std::string &str, std::string_view expanded) {
 	if (lexerState->mode != LEXER_RAW) {
 		str.append(expanded);
 		return;
@@ -1415,8 +1756,8 @@ static void appendCharInLiteral(std::string &str, int c) {
 	case '8':
 	case '9':
 	case '<':
-		if (std::shared_ptr<std::string> arg = readMacroArg(); arg) {
-			appendExpandedString(str, *arg);
+		if (std::optional<MacroArgText> arg = readMacroArg(); arg) {
+			appendExpandedString(str, arg->text);
 		}
 		break;
 
@@ -1791,13 +2132,13 @@ static Token yylex_NORMAL() {
 		case '"': {
 			std::string str;
 			readString(str, false);
-			return Token(T_(STRING), str);
+			return Token(T_(STRING), std::move(str));
 		}
 
 		case '\'': {
 			std::string chr;
 			readCharacter(chr);
-			return Token(T_(CHARACTER), chr);
+			return Token(T_(CHARACTER), std::move(chr));
 		}
 
 			// Handle newlines and EOF
@@ -1826,7 +2167,7 @@ static Token yylex_NORMAL() {
 				shiftChar();
 				std::string str;
 				readString(str, true);
-				return Token(T_(STRING), str);
+				return Token(T_(STRING), std::move(str));
 			}
 			[[fallthrough]];
 
@@ -1846,6 +2187,7 @@ static Token yylex_NORMAL() {
 			// An ELIF after a taken IF needs to not evaluate its condition
 			if (token.type == T_(POP_ELIF) && lexerState->lastToken == T_(NEWLINE)
 			    && lexer_GetIFDepth() > 0 && lexer_RanIFBlock() && !lexer_ReachedELSEBlock()) {
+				tokenIsCacheable = false;
 				return yylex_SKIP_TO_ENDC();
 			}
 
@@ -1859,6 +2201,7 @@ static Token yylex_NORMAL() {
 			InternedStr identifier = std::get<InternedStr>(token.value);
 
 			// Raw symbols and local symbols cannot be string expansions
+			tokenMayExpand = !raw && token.type == T_(SYMBOL);
 			if (!raw && token.type == T_(SYMBOL) && lexerState->enableStringExpansions) {
 				// Attempt string expansion
 				if (Symbol const *sym = sym_FindExactSymbol(identifier);
@@ -2027,7 +2370,7 @@ finish: // Can't `break` out of a nested `for`-`switch`
 	// mode end the current macro argument but are not tokenized themselves.
 	if (c == ',') {
 		shiftChar();
-		return Token(T_(STRING), str);
+		return Token(T_(STRING), std::move(str));
 	}
 
 	// The last argument may end in a trailing comma, newline, or EOF.
@@ -2037,7 +2380,7 @@ finish: // Can't `break` out of a nested `for`-`switch`
 	// macro argument. To pass an empty last argument, use a second
 	// trailing comma.
 	if (!str.empty()) {
-		return Token(T_(STRING), str);
+		return Token(T_(STRING), std::move(str));
 	}
 
 	lexer_SetMode(LEXER_NORMAL);
@@ -2053,7 +2396,7 @@ finish: // Can't `break` out of a nested `for`-`switch`
 
 // This map lists all RGBASM keywords which `skipToLeadingKeyword` needs to recognize.
 // It is a subset of `keywords`.
-static UpperMap<int> const leadingKeywords{
+static KeywordMap<int> const leadingKeywords{
     // There is no need to recognize "MACRO", since macros cannot be nested
     {"ENDM", T_(POP_ENDM)},
 
@@ -2067,31 +2410,102 @@ static UpperMap<int> const leadingKeywords{
     {"ENDC", T_(POP_ENDC)},
 };
 
-static Token skipToLeadingKeywordFast(Procedure<> auto shiftFast) {
+void KeywordIndex::build(ContentSpan const &content) {
+	// This finds the same leading keywords as `skipToLeadingKeywordFast` would, for every line
+	char const *ptr = content.ptr.get();
+	char const *end = ptr + content.size;
+	for (char const *c = ptr;;) {
+		size_t lineStart = c - ptr;
+		while (c != end && isBlankSpace(*c)) {
+			++c;
+		}
+		if (c != end && isLetter(*c)) {
+			char const *start = c;
+			for (++c; c != end && continuesIdentifier(*c); ++c) {}
+			if (int const *type = leadingKeywords.find(std::string_view{start, c}); type) {
+				entries.push_back({
+				    .lineStart = lineStart,
+				    .keywordEnd = static_cast<size_t>(c - ptr),
+				    .type = *type,
+				});
+			}
+		}
+		c = findNewline(c, end);
+		if (c == end) {
+			break;
+		}
+		if (*c == '\r' && c + 1 != end && c[1] == '\n') {
+			++c;
+		}
+		++c;
+		lineStarts.push_back(c - ptr);
+	}
+	built = true;
+}
+
+static Token skipToIndexedKeyword(KeywordIndex &index, Procedure<size_t> auto shiftFast) {
+	if (!index.built) {
+		index.build(lexerState->content);
+	}
+
+	// The next leading keyword is on the first line starting after the current offset,
+	// or starting at it if it is the start of a line
+	size_t offset = lexerState->offset;
+	auto entry = lexerState->atLineStart
+	                 ? std::partition_point(
+	                       RANGE(index.entries),
+	                       [&](KeywordIndex::Entry const &e) { return e.lineStart < offset; }
+	                   )
+	                 : std::partition_point(
+	                       RANGE(index.entries),
+	                       [&](KeywordIndex::Entry const &e) { return e.lineStart <= offset; }
+	                   );
+	lexerState->atLineStart = false;
+
+	size_t size = lexerState->content.size;
+	// Without a keyword left, skip to EOF (and past it, like `skipToLeadingKeywordFast`)
+	size_t target = entry != index.entries.end() ? entry->keywordEnd : std::max(offset, size) + 1;
+	lexerState->lineNo += index.nbNewlinesBefore(std::min(target, size))
+	                      - index.nbNewlinesBefore(std::min(offset, size));
+	shiftFast(target - offset);
+
+	if (entry == index.entries.end()) {
+		return Token(T_(YYEOF));
+	}
+	// See `skipToLeadingKeywordFast` for why this is necessary
+	if (lexerState->expansionScanDistance == 0) {
+		++lexerState->expansionScanDistance;
+	}
+	return Token(entry->type);
+}
+
+static Token skipToLeadingKeywordFast(Procedure<size_t> auto shiftFast) {
 	// This is essentially `skipToLeadingKeyword` with `peek` and `shiftChar` replaced,
 	// as well as anything that calls them like `nextChar` or `handleCRLF`.
 	char const *ptr = lexerState->content.ptr.get();
+	char const *end = ptr + lexerState->content.size;
 	auto peekFast = [&]() {
 		return lexerState->offset < lexerState->content.size ? ptr[lexerState->offset] : EOF;
 	};
 	for (;;) {
-		int c = peekFast();
 		if (lexerState->atLineStart) {
 			lexerState->atLineStart = false;
+			int c = peekFast();
 			while (isBlankSpace(c)) {
-				shiftFast();
+				shiftFast(1);
 				c = peekFast();
 			}
 			if (c == EOF) {
+				shiftFast(1);
 				return Token(T_(YYEOF));
 			} else if (isLetter(c)) {
 				size_t start = lexerState->offset;
-				shiftFast();
+				shiftFast(1);
 				for (c = peekFast(); continuesIdentifier(c); c = peekFast()) {
-					shiftFast();
+					shiftFast(1);
 				}
 				std::string_view leading{ptr + start, ptr + lexerState->offset};
-				if (auto search = leadingKeywords.find(leading); search != leadingKeywords.end()) {
+				if (int const *type = leadingKeywords.find(leading); type) {
 					// When this branch returns a token, there has been one more call to `peekFast`
 					// than to `shiftFast`. Unlike `peek` and `shiftChar`, the optimized functions
 					// do not update `lexerState->expansionScanDistance`, so it must be incremented
@@ -2099,20 +2513,22 @@ static Token skipToLeadingKeywordFast(Procedure<> auto shiftFast) {
 					if (lexerState->expansionScanDistance == 0) {
 						++lexerState->expansionScanDistance;
 					}
-					return Token(search->second);
+					return Token(*type);
 				}
 			}
 		}
-		shiftFast();
-		if (c == EOF) {
+		// Nothing but a newline matters until the next line start, so skip straight past it
+		char const *cur = ptr + std::min(lexerState->offset, lexerState->content.size);
+		char const *newline = findNewline(cur, end);
+		shiftFast(newline - cur + 1);
+		if (newline == end) {
 			return Token(T_(YYEOF));
-		} else if (isNewline(c)) {
-			if (c == '\r' && peekFast() == '\n') {
-				shiftFast();
-			}
-			++lexerState->lineNo;
-			lexerState->atLineStart = true;
 		}
+		if (*newline == '\r' && peekFast() == '\n') {
+			shiftFast(1);
+		}
+		++lexerState->lineNo;
+		lexerState->atLineStart = true;
 	}
 }
 
@@ -2132,14 +2548,20 @@ static Token skipToLeadingKeyword() {
 	if (lexerState->expansionStack.empty()) {
 		// Optimize the common case (no ongoing expansions) to avoid
 		// the bookkeeping of `peek` and `shiftChar`.
+		auto skipFast = [&](Procedure<size_t> auto shiftFast) {
+			if (KeywordIndex *index = lexerState->content.keywordIndex.get(); index) {
+				return skipToIndexedKeyword(*index, shiftFast);
+			}
+			return skipToLeadingKeywordFast(shiftFast);
+		};
 		if (lexerState->capturing) {
 			assume(lexerState->captureBuf == nullptr);
-			return skipToLeadingKeywordFast([&]() {
-				++lexerState->offset;
-				++lexerState->captureSize;
+			return skipFast([&](size_t n) {
+				lexerState->offset += n;
+				lexerState->captureSize += n;
 			});
 		} else {
-			return skipToLeadingKeywordFast([&]() { ++lexerState->offset; });
+			return skipFast([&](size_t n) { lexerState->offset += n; });
 		}
 	}
 
@@ -2155,8 +2577,8 @@ static Token skipToLeadingKeyword() {
 				for (c = nextChar(); continuesIdentifier(c); c = nextChar()) {
 					builder += c;
 				}
-				if (auto search = leadingKeywords.find(builder); search != leadingKeywords.end()) {
-					return Token(search->second);
+				if (int const *type = leadingKeywords.find(builder); type) {
+					return Token(*type);
 				}
 			}
 		}
@@ -2245,6 +2667,56 @@ static Token yylex_SKIP_TO_ENDR() {
 	}
 }
 
+static bool isExpandable(CachedToken const &cached) {
+	if (!cached.mayExpand || !lexerState->enableStringExpansions) {
+		return false;
+	}
+	assume(std::holds_alternative<InternedStr>(cached.token.value));
+	Symbol const *sym = sym_FindExactSymbol(std::get<InternedStr>(cached.token.value));
+	return sym && sym->type == SYM_EQUS;
+}
+
+// This is `yylex_NORMAL` for loop bodies, which replays the tokens lexed by earlier iterations.
+// Tokens are only replayed when nothing that could have changed them differs from when they were
+// first lexed, so any expansions, diagnostics, etc. are performed again by lexing normally.
+static Token yylex_CACHED(TokenCache &cache) {
+	if (!cache.matchesOptions()) {
+		cache.reset();
+	}
+
+	size_t startOffset = lexerState->offset;
+	if (auto search = cache.tokens.find(startOffset);
+	    search != cache.tokens.end() && !isExpandable(search->second)) {
+		CachedToken const &cached = search->second;
+		lexerState->offset = cached.endOffset;
+		lexerState->lineNo = cached.lineNo;
+		lexerState->expansionScanDistance = cached.expansionScanDistance;
+		return cached.token;
+	}
+
+	tokenIsCacheable = true;
+	tokenMayExpand = false;
+	uint64_t startDiagnostics = nbDiagnostics;
+
+	Token token = yylex_NORMAL();
+
+	if (tokenIsCacheable && nbDiagnostics == startDiagnostics && token.type != T_(YYEOF)
+	    && lexerState->mode == LEXER_NORMAL && lexerState->nextToken == 0
+	    && lexerState->expansionStack.empty()) {
+		cache.tokens.insert_or_assign(
+		    startOffset,
+		    CachedToken{
+		        .token = token,
+		        .endOffset = lexerState->offset,
+		        .lineNo = lexerState->lineNo,
+		        .expansionScanDistance = lexerState->expansionScanDistance,
+		        .mayExpand = tokenMayExpand,
+		    }
+		);
+	}
+	return token;
+}
+
 // LCOV_EXCL_START
 static void verboseOutputString(std::string_view str) {
 	static constexpr size_t max_len = 40;
@@ -2294,7 +2766,11 @@ yy::parser::symbol_type yylex() {
 	    yylex_SKIP_TO_ENDC,
 	    yylex_SKIP_TO_ENDR,
 	};
-	Token token = lexerModeFuncs[lexerState->mode]();
+	Token token = lexerState->tokenCache && lexerState->mode == LEXER_NORMAL
+	                      && lexerState->nextToken == 0 && lexerState->expansionStack.empty()
+	                  ? yylex_CACHED(*lexerState->tokenCache)
+	                  : lexerModeFuncs[lexerState->mode]();
+	++nbTokensLexed;
 
 	// Captures end at their buffer's boundary no matter what
 	if (token.type == T_(YYEOF) && !lexerState->capturing) {
@@ -2321,7 +2797,7 @@ yy::parser::symbol_type yylex() {
 			fputs(")\n", stderr);
 		});
 		// LCOV_EXCL_STOP
-		return yy::parser::symbol_type(token.type, std::get<std::string>(token.value));
+		return yy::parser::symbol_type(token.type, std::move(std::get<std::string>(token.value)));
 	} else if (std::holds_alternative<InternedStr>(token.value)) {
 		// LCOV_EXCL_START
 		verboseDo(VERB_TRACE, [&]() {
@@ -2387,6 +2863,17 @@ static Capture makeCapture(char const *name, InvocableR<int, int> auto callback)
 		}
 	}
 
+	if (capture.span.ptr) {
+		// Record where expansions may begin once, so lexing the capture can skip checking for them
+		auto expansionOffsets = std::make_shared<std::vector<size_t>>();
+		std::string_view body{capture.span.ptr.get(), capture.span.size};
+		for (size_t i = body.find_first_of("\\{"); i != body.npos;
+		     i = body.find_first_of("\\{", i + 1)) {
+			expansionOffsets->push_back(i);
+		}
+		capture.span.expansionOffsets = expansionOffsets;
+	}
+
 	// LCOV_EXCL_START
 	verboseDo(VERB_TRACE, [&]() {
 		if (capture.span.ptr) {
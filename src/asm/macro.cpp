@@ -3,72 +3,66 @@
 #include "asm/macro.hpp"
 
 #include <memory>
+#include <optional>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <string>
+#include <string_view>
 
 #include "helpers.hpp" // assume
 
 #include "asm/warning.hpp"
 
-std::shared_ptr<std::string> MacroArgs::getArg(int32_t num) const {
+std::string_view MacroArgs::argAt(size_t i) const {
+	size_t end = i + 1 < offsets.size() ? offsets[i + 1] : buffer->size();
+	return std::string_view{*buffer}.substr(offsets[i], end - 1 - offsets[i]); // 1 for comma
+}
+
+std::optional<std::string_view> MacroArgs::getArg(int32_t num) const {
 	assume(num != 0);
 	if (num > 0) {
 		// Macro arguments adjust 1-based indexes by the shift amount.
-		if (size_t i = num - 1 + shift; i < args.size()) {
-			return args[i];
+		if (size_t i = num - 1 + shift; i < offsets.size()) {
+			return argAt(i);
 		}
 	} else {
 		// Bracketed macro arguments adjust negative indexes such that -1 is the last argument.
-		if (num == INT32_MIN || static_cast<size_t>(-num) > args.size()) {
-			return nullptr;
-		} else if (size_t i = args.size() - static_cast<size_t>(-num); i >= shift) {
-			return args[i];
+		if (num == INT32_MIN || static_cast<size_t>(-num) > offsets.size()) {
+			return std::nullopt;
+		} else if (size_t i = offsets.size() - static_cast<size_t>(-num); i >= shift) {
+			return argAt(i);
 		}
 	}
-	return nullptr;
+	return std::nullopt;
 }
 
-std::shared_ptr<std::string> MacroArgs::getAllArgs() const {
-	size_t nbArgs = args.size();
-
-	if (shift >= nbArgs) {
-		return std::make_shared<std::string>("");
+std::string_view MacroArgs::getAllArgs() const {
+	if (shift >= offsets.size()) {
+		return "";
 	}
 
-	size_t len = 0;
-
-	for (uint32_t i = shift; i < nbArgs; ++i) {
-		len += args[i]->length() + 1; // 1 for comma
+	// Commas go between args and after a last empty arg, so only drop the final comma
+	// if the last arg is not empty
+	size_t end = buffer->size();
+	if (end - offsets.back() > 1) {
+		--end;
 	}
-
-	auto str = std::make_shared<std::string>();
-	str->reserve(len + 1); // 1 for comma
-
-	for (uint32_t i = shift; i < nbArgs; ++i) {
-		std::shared_ptr<std::string> const &arg = args[i];
-
-		str->append(*arg);
-
-		// Commas go between args and after a last empty arg
-		if (i < nbArgs - 1 || arg->empty()) {
-			str->push_back(','); // no space after comma
-		}
-	}
-
-	return str;
+	return std::string_view{*buffer}.substr(offsets[shift], end - offsets[shift]);
 }
 
-void MacroArgs::appendArg(std::shared_ptr<std::string> arg) {
-	if (arg->empty()) {
+void MacroArgs::appendArg(std::string const &arg) {
+	if (arg.empty()) {
 		warning(WARNING_EMPTY_MACRO_ARG, "Empty macro argument");
 	}
-	args.push_back(arg);
+	offsets.push_back(buffer->size());
+	buffer->append(arg);
+	buffer->push_back(','); // no space after comma
 }
 
 void MacroArgs::shiftArgs(int32_t count) {
-	if (size_t nbArgs = args.size();
+	if (size_t nbArgs = offsets.size();
 	    count > 0 && (static_cast<uint32_t>(count) > nbArgs || shift > nbArgs - count)) {
 		warning(WARNING_MACRO_SHIFT, "Cannot shift macro arguments past their end");
 		shift = nbArgs;
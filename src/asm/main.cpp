@@ -31,6 +31,7 @@
 
 #include "asm/charmap.hpp"
 #include "asm/fstack.hpp"
+#include "asm/lexer.hpp"
 #include "asm/opt.hpp"
 #include "asm/output.hpp"
 #include "asm/section.hpp"
@@ -50,7 +51,7 @@ static struct LocalOptions {
 static char const *optstring = "B:b:D:Eg:hI:M:o:P:p:Q:r:s:VvW:wX:";
 
 // Long-only option variable
-static int longOpt; // `--color` and variants of `-M`
+static int longOpt; // `--color`, `--compact-object`, `--list-include-dirs`, and variants of `-M`
 
 // Equivalent long options
 // Please keep in the same order as short opts.
@@ -60,31 +61,33 @@ static int longOpt; // `--color` and variants of `-M`
 // This is because long opt matching, even to a single char, is prioritized
 // over short opt matching.
 static option const longopts[] = {
-    {"backtrace",       required_argument, nullptr,  'B'},
-    {"binary-digits",   required_argument, nullptr,  'b'},
-    {"define",          required_argument, nullptr,  'D'},
-    {"export-all",      no_argument,       nullptr,  'E'},
-    {"gfx-chars",       required_argument, nullptr,  'g'},
-    {"help",            no_argument,       nullptr,  'h'},
-    {"include",         required_argument, nullptr,  'I'},
-    {"dependfile",      required_argument, nullptr,  'M'},
-    {"output",          required_argument, nullptr,  'o'},
-    {"preinclude",      required_argument, nullptr,  'P'},
-    {"pad-value",       required_argument, nullptr,  'p'},
-    {"q-precision",     required_argument, nullptr,  'Q'},
-    {"recursion-depth", required_argument, nullptr,  'r'},
-    {"state",           required_argument, nullptr,  's'},
-    {"version",         no_argument,       nullptr,  'V'},
-    {"verbose",         no_argument,       nullptr,  'v'},
-    {"warning",         required_argument, nullptr,  'W'},
-    {"max-errors",      required_argument, nullptr,  'X'},
-    {"color",           required_argument, &longOpt, 'c'},
-    {"MC",              no_argument,       &longOpt, 'C'},
-    {"MG",              no_argument,       &longOpt, 'G'},
-    {"MP",              no_argument,       &longOpt, 'P'},
-    {"MQ",              required_argument, &longOpt, 'Q'},
-    {"MT",              required_argument, &longOpt, 'T'},
-    {nullptr,           no_argument,       nullptr,  0  },
+    {"backtrace",         required_argument, nullptr,  'B'},
+    {"binary-digits",     required_argument, nullptr,  'b'},
+    {"define",            required_argument, nullptr,  'D'},
+    {"export-all",        no_argument,       nullptr,  'E'},
+    {"gfx-chars",         required_argument, nullptr,  'g'},
+    {"help",              no_argument,       nullptr,  'h'},
+    {"include",           required_argument, nullptr,  'I'},
+    {"dependfile",        required_argument, nullptr,  'M'},
+    {"output",            required_argument, nullptr,  'o'},
+    {"preinclude",        required_argument, nullptr,  'P'},
+    {"pad-value",         required_argument, nullptr,  'p'},
+    {"q-precision",       required_argument, nullptr,  'Q'},
+    {"recursion-depth",   required_argument, nullptr,  'r'},
+    {"state",             required_argument, nullptr,  's'},
+    {"version",           no_argument,       nullptr,  'V'},
+    {"verbose",           no_argument,       nullptr,  'v'},
+    {"warning",           required_argument, nullptr,  'W'},
+    {"max-errors",        required_argument, nullptr,  'X'},
+    {"color",             required_argument, &longOpt, 'c'},
+    {"compact-object",    no_argument,       &longOpt, 'O'},
+    {"list-include-dirs", no_argument,       &longOpt, 'L'},
+    {"MC",                no_argument,       &longOpt, 'C'},
+    {"MG",                no_argument,       &longOpt, 'G'},
+    {"MP",                no_argument,       &longOpt, 'P'},
+    {"MQ",                required_argument, &longOpt, 'Q'},
+    {"MT",                required_argument, &longOpt, 'T'},
+    {nullptr,             no_argument,       nullptr,  0  },
 };
 
 // clang-format off: nested initializers
@@ -328,6 +331,14 @@ static void parseArg(int ch, char *arg) {
 			}
 			break;
 
+		case 'O':
+			options.compactObject = true;
+			break;
+
+		case 'L':
+			options.listIncludeDirs = true;
+			break;
+
 		case 'C':
 			options.missingIncludeState = GEN_CONTINUE;
 			break;
@@ -563,6 +574,8 @@ int main(int argc, char *argv[]) {
 		return 0;
 	}
 
+	verboseDo(VERB_INFO, lexer_VerboseOutputStats);
+
 	sect_CheckUnionClosed();
 	sect_CheckLoadClosed();
 	sect_CheckSizes();
@@ -5,19 +5,27 @@
 #include <algorithm>
 #include <deque>
 #include <errno.h>
+#include <fcntl.h>
+#include <filesystem>
 #include <inttypes.h>
 #include <memory>
+#include <optional>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
 #include <vector>
 
 #include "helpers.hpp" // assume, Defer
 #include "linkdefs.hpp"
+#include "opmath.hpp"
 #include "platform.hpp"
-#include "util.hpp" // xfclose
+#include "util.hpp" // xclose, xfclose
+#include "verbosity.hpp"
 
 #include "asm/charmap.hpp"
 #include "asm/fstack.hpp"
@@ -39,22 +47,26 @@ struct Assertion {
 static std::vector<Symbol *> objectSymbols;
 
 static std::deque<Assertion> assertions;
+static std::vector<uint8_t> assertionRPNData; // Serialized RPN of all `assertions`, contiguously
 
 static std::deque<std::shared_ptr<FileStackNode>> fileStackNodes;
 
-static void putLong(uint32_t n, FILE *file) {
-	uint8_t bytes[] = {
-	    static_cast<uint8_t>(n),
-	    static_cast<uint8_t>(n >> 8),
-	    static_cast<uint8_t>(n >> 16),
-	    static_cast<uint8_t>(n >> 24),
-	};
-	fwrite(bytes, 1, sizeof(bytes), file);
+// The object file is serialized to a buffer first, so that it is written all at once
+static void putLong(uint32_t n, std::vector<uint8_t> &buffer) {
+	buffer.insert(
+	    buffer.end(),
+	    {static_cast<uint8_t>(n),
+	     static_cast<uint8_t>(n >> 8),
+	     static_cast<uint8_t>(n >> 16),
+	     static_cast<uint8_t>(n >> 24)}
+	);
 }
 
-static void putString(std::string const &s, FILE *file) {
-	fputs(s.c_str(), file);
-	putc('\0', file);
+static void putString(std::string_view s, std::vector<uint8_t> &buffer) {
+	// Like `fputs`, stop at any NUL char, since the string is NUL-terminated
+	s = s.substr(0, s.find('\0'));
+	buffer.insert(buffer.end(), RANGE(s));
+	buffer.push_back('\0');
 }
 
 void out_RegisterNode(std::shared_ptr<FileStackNode> node) {
@@ -65,63 +77,69 @@ void out_RegisterNode(std::shared_ptr<FileStackNode> node) {
 	}
 }
 
-static void writePatch(Patch const &patch, FILE *file) {
-	assume(patch.src->ID != UINT32_MAX);
-
-	putLong(patch.src->ID, file);
-	putLong(patch.lineNo, file);
-	putLong(patch.offset, file);
-	putLong(patch.pcSection ? patch.pcSection->getID() : UINT32_MAX, file);
-	putLong(patch.pcOffset, file);
-	putc(patch.type, file);
-	putLong(patch.rpn.size(), file);
-	fwrite(patch.rpn.data(), 1, patch.rpn.size(), file);
+static void writePatch(
+    Patch const &patch, std::vector<uint8_t> const &rpnData, std::vector<uint8_t> &buffer
+) {
+	assume(patch.srcID != UINT32_MAX);
+
+	putLong(patch.srcID, buffer);
+	putLong(patch.lineNo, buffer);
+	putLong(patch.offset, buffer);
+	putLong(patch.pcSection ? patch.pcSection->getID() : UINT32_MAX, buffer);
+	putLong(patch.pcOffset, buffer);
+	buffer.push_back(patch.type);
+	putLong(patch.rpnSize, buffer);
+	buffer.insert(
+	    buffer.end(),
+	    rpnData.begin() + patch.rpnOfs,
+	    rpnData.begin() + patch.rpnOfs + patch.rpnSize
+	);
 }
 
-static void writeSection(Section const &sect, FILE *file) {
+static void writeSection(Section const &sect, std::vector<uint8_t> &buffer) {
 	assume(sect.src->ID != UINT32_MAX);
 
-	putString(sect.name, file);
+	putString(sect.name, buffer);
 
-	putLong(sect.src->ID, file);
-	putLong(sect.fileLine, file);
+	putLong(sect.src->ID, buffer);
+	putLong(sect.fileLine, buffer);
 
-	putLong(sect.size, file);
+	putLong(sect.size, buffer);
 
 	assume((sect.type & SECTTYPE_TYPE_MASK) == sect.type);
 	bool isUnion = sect.modifier == SECTION_UNION;
 	bool isFragment = sect.modifier == SECTION_FRAGMENT;
-	putc(sect.type | isUnion << SECTTYPE_UNION_BIT | isFragment << SECTTYPE_FRAGMENT_BIT, file);
+	buffer.push_back(sect.type | isUnion << SECTTYPE_UNION_BIT | isFragment << SECTTYPE_FRAGMENT_BIT);
 
-	putLong(sect.org, file);
-	putLong(sect.bank, file);
-	putc(sect.align, file);
-	putLong(sect.alignOfs, file);
+	putLong(sect.org, buffer);
+	putLong(sect.bank, buffer);
+	buffer.push_back(sect.align);
+	putLong(sect.alignOfs, buffer);
 
 	if (sectTypeHasData(sect.type)) {
-		fwrite(sect.data.data(), 1, sect.size, file);
-		putLong(sect.patches.size(), file);
+		buffer.insert(buffer.end(), sect.data.begin(), sect.data.begin() + sect.size);
+		putLong(sect.patches.size(), buffer);
 
 		for (Patch const &patch : sect.patches) {
-			writePatch(patch, file);
+			writePatch(patch, sect.rpnData, buffer);
 		}
 	}
 }
 
-static void writeSymbol(Symbol const &sym, FILE *file) {
-	putString(sym.name.str(), file);
+static void writeSymbol(Symbol const &sym, std::vector<uint8_t> &buffer) {
+	putString(sym.name.str(), buffer);
 	if (!sym.isDefined()) {
-		putc(SYMTYPE_IMPORT, file);
+		buffer.push_back(SYMTYPE_IMPORT);
 	} else {
 		assume(sym.src->ID != UINT32_MAX);
 
 		Section *symSection = sym.getSection();
 
-		putc(sym.isExported ? SYMTYPE_EXPORT : SYMTYPE_LOCAL, file);
-		putLong(sym.src->ID, file);
-		putLong(sym.fileLine, file);
-		putLong(symSection ? symSection->getID() : UINT32_MAX, file);
-		putLong(sym.getOutputValue(), file);
+		buffer.push_back(sym.isExported ? SYMTYPE_EXPORT : SYMTYPE_LOCAL);
+		putLong(sym.src->ID, buffer);
+		putLong(sym.fileLine, buffer);
+		putLong(symSection ? symSection->getID() : UINT32_MAX, buffer);
+		putLong(sym.getOutputValue(), buffer);
 	}
 }
 
@@ -134,24 +152,34 @@ void out_RegisterSymbol(Symbol &sym) {
 	}
 }
 
-static void initPatch(Patch &patch, uint32_t type, Expression const &expr, uint32_t ofs) {
-	patch.type = type;
-	patch.src = fstk_GetFileStack();
+static void initPatch(
+    Patch &patch,
+    std::vector<uint8_t> &rpnData,
+    uint32_t type,
+    Expression const &expr,
+    uint32_t ofs
+) {
+	std::shared_ptr<FileStackNode> src = fstk_GetFileStack();
 	// All patches are assumed to eventually be written, so the file stack node is registered
-	out_RegisterNode(patch.src);
+	out_RegisterNode(src);
+	patch.srcID = src->ID;
+	patch.type = type;
 	patch.lineNo = lexer_GetLineNo();
 	patch.offset = ofs;
 	patch.pcSection = sect_GetSymbolSection();
 	patch.pcOffset = sect_GetSymbolOffset();
-	expr.encode(patch.rpn);
+	patch.rpnOfs = rpnData.size();
+	expr.encode(rpnData);
+	patch.rpnSize = rpnData.size() - patch.rpnOfs;
 }
 
 void out_CreatePatch(uint32_t type, Expression const &expr, uint32_t ofs, uint32_t pcShift) {
 	// Add the patch to the list
-	assume(sect_GetOutputBank().has_value());
-	Patch &patch = *sect_AddOutputPatch();
+	Section *sect = sect_GetOutputSection();
+	assume(sect);
+	Patch &patch = sect->patches.emplace_front();
 
-	initPatch(patch, type, expr, ofs);
+	initPatch(patch, sect->rpnData, type, expr, ofs);
 
 	// If the patch had a quantity of bytes output before it,
 	// PC is not at the patch's location, but at the location
@@ -164,82 +192,703 @@ void out_CreateAssert(
 ) {
 	Assertion &assertion = assertions.emplace_front();
 
-	initPatch(assertion.patch, type, expr, ofs);
+	initPatch(assertion.patch, assertionRPNData, type, expr, ofs);
 	assertion.message = message;
 }
 
-static void writeAssert(Assertion const &assert, FILE *file) {
-	writePatch(assert.patch, file);
-	putString(assert.message, file);
+static void writeAssert(Assertion const &assert, std::vector<uint8_t> &buffer) {
+	writePatch(assert.patch, assertionRPNData, buffer);
+	putString(assert.message, buffer);
 }
 
-static void writeFileStackNode(FileStackNode const &node, FILE *file) {
-	putLong(node.parent ? node.parent->ID : UINT32_MAX, file);
-	putLong(node.lineNo, file);
+static void writeFileStackNode(FileStackNode const &node, std::vector<uint8_t> &buffer) {
+	putLong(node.parent ? node.parent->ID : UINT32_MAX, buffer);
+	putLong(node.lineNo, buffer);
 
-	putc(node.type | node.isQuiet << FSTACKNODE_QUIET_BIT, file);
+	buffer.push_back(node.type | node.isQuiet << FSTACKNODE_QUIET_BIT);
 
 	if (node.type != NODE_REPT) {
-		putString(node.name(), file);
+		putString(node.name(), buffer);
 	} else {
-		std::vector<uint32_t> const &nodeIters = node.iters();
+		// Outer iteration counts are stored by the parent REPT nodes
+		putLong(node.iter(), buffer);
+	}
+}
+
+// A value computed ahead of rgblink; label values in floating sections are kept relative to
+// their section, so that differences between labels of the same section can still be known
+struct LinkValue {
+	int32_t value;
+	Section const *section; // If not null, `value` is an offset from this floating section's start
+};
+
+// Labels in fragments are placed by rgblink after other objects' pieces, so they are never known
+static std::optional<LinkValue> labelValue(Section const *sect, uint32_t offset) {
+	if (!sect || sect->modifier == SECTION_FRAGMENT) {
+		return std::nullopt;
+	}
+	if (sect->org != UINT32_MAX) {
+		return LinkValue{.value = static_cast<int32_t>(sect->org + offset), .section = nullptr};
+	}
+	return LinkValue{.value = static_cast<int32_t>(offset), .section = sect};
+}
+
+static uint32_t readRPNLong(uint8_t const *&ptr) {
+	uint32_t value = ptr[0] | ptr[1] << 8 | ptr[2] << 16 | static_cast<uint32_t>(ptr[3]) << 24;
+	ptr += 4;
+	return value;
+}
+
+// Computes a patch's value as rgblink would, if that is already possible without any diagnostic;
+// anything which rgblink may warn or error about is left for it to report
+static std::optional<LinkValue>
+    tryComputeLinkValue(Patch const &patch, std::vector<uint8_t> const &rpnData) {
+	std::vector<LinkValue> stack;
+	uint8_t const *ptr = &rpnData[patch.rpnOfs];
+	uint8_t const *end = ptr + patch.rpnSize;
+
+	while (ptr != end) {
+		RPNCommand command = static_cast<RPNCommand>(*ptr++);
+
+		// Operands which are symbols and sections
+		std::optional<LinkValue> operand;
+		switch (command) {
+		case RPN_CONST:
+			operand = LinkValue{.value = static_cast<int32_t>(readRPNLong(ptr)), .section = nullptr};
+			break;
+
+		case RPN_SYM:
+			if (uint32_t symID = readRPNLong(ptr); symID == UINT32_MAX) { // PC
+				operand = labelValue(patch.pcSection, patch.pcOffset);
+			} else if (Symbol const *sym = objectSymbols[symID]; sym->type == SYM_LABEL) {
+				operand = labelValue(sym->getSection(), sym->getOutputValue());
+			} else if (sym->type == SYM_EQU || sym->type == SYM_VAR) {
+				operand = LinkValue{.value = sym->getOutputValue(), .section = nullptr};
+			}
+			break;
 
-		putLong(nodeIters.size(), file);
-		// Iters are stored by decreasing depth, so reverse the order for output
-		for (uint32_t iter : reversed(nodeIters)) {
-			putLong(iter, file);
+		case RPN_BANK_SYM:
+			if (Symbol const *sym = objectSymbols[readRPNLong(ptr)]; sym->type == SYM_LABEL) {
+				if (Section const *sect = sym->getSection(); sect && sect->bank != UINT32_MAX) {
+					operand = LinkValue{.value = static_cast<int32_t>(sect->bank), .section = nullptr};
+				}
+			}
+			break;
+
+		case RPN_BANK_SELF:
+			if (patch.pcSection && patch.pcSection->bank != UINT32_MAX) {
+				operand = LinkValue{
+				    .value = static_cast<int32_t>(patch.pcSection->bank), .section = nullptr
+				};
+			}
+			break;
+
+		case RPN_BANK_SECT:
+		case RPN_SIZEOF_SECT:
+		case RPN_STARTOF_SECT: {
+			std::string name(reinterpret_cast<char const *>(ptr));
+			ptr += name.length() + 1;
+			// Sizes may still grow with other objects' pieces, so they are never known
+			if (Section const *sect = sect_FindSectionByName(name); !sect) {
+				break;
+			} else if (command == RPN_BANK_SECT && sect->bank != UINT32_MAX) {
+				operand = LinkValue{.value = static_cast<int32_t>(sect->bank), .section = nullptr};
+			} else if (command == RPN_STARTOF_SECT && sect->org != UINT32_MAX) {
+				operand = LinkValue{.value = static_cast<int32_t>(sect->org), .section = nullptr};
+			}
+			break;
 		}
+
+		case RPN_SIZEOF_SECTTYPE:
+			// Section type sizes may be changed by rgblink's options, so they are never known
+			++ptr;
+			break;
+
+		case RPN_STARTOF_SECTTYPE:
+			operand = LinkValue{
+			    .value = static_cast<int32_t>(sectionTypeInfo[*ptr++].startAddr), .section = nullptr
+			};
+			break;
+
+		default: {
+			// Operators; only label differences and offsets may involve relative values
+			LinkValue rhs = stack.back();
+			stack.pop_back();
+			if (command == RPN_ADD || command == RPN_SUB) {
+				LinkValue lhs = stack.back();
+				stack.pop_back();
+				if (command == RPN_ADD && !(lhs.section && rhs.section)) {
+					operand = LinkValue{
+					    .value = static_cast<int32_t>(
+					        static_cast<uint32_t>(lhs.value) + static_cast<uint32_t>(rhs.value)
+					    ),
+					    .section = lhs.section ? lhs.section : rhs.section,
+					};
+				} else if (command == RPN_SUB && (!rhs.section || rhs.section == lhs.section)) {
+					operand = LinkValue{
+					    .value = static_cast<int32_t>(
+					        static_cast<uint32_t>(lhs.value) - static_cast<uint32_t>(rhs.value)
+					    ),
+					    .section = rhs.section ? nullptr : lhs.section,
+					};
+				}
+				break;
+			}
+			if (rhs.section) {
+				return std::nullopt;
+			}
+			int32_t rval = rhs.value;
+			int32_t value;
+			switch (command) {
+			case RPN_NEG:
+				value = op_neg(rval);
+				break;
+			case RPN_NOT:
+				value = ~rval;
+				break;
+			case RPN_LOGNOT:
+				value = !rval;
+				break;
+			case RPN_HIGH:
+				value = op_high(rval);
+				break;
+			case RPN_LOW:
+				value = op_low(rval);
+				break;
+			case RPN_BITWIDTH:
+				value = op_bitwidth(rval);
+				break;
+			case RPN_TZCOUNT:
+				value = op_tzcount(rval);
+				break;
+			case RPN_HRAM:
+				if (rval < 0xFF00 || rval > 0xFFFF) {
+					return std::nullopt;
+				}
+				value = rval & 0xFF;
+				break;
+			case RPN_RST:
+				if (rval & ~0x38) {
+					return std::nullopt;
+				}
+				value = rval | 0xC7;
+				break;
+			case RPN_BIT_INDEX:
+				if (rval & ~0x07) {
+					return std::nullopt;
+				}
+				value = *ptr++ | rval << 3;
+				break;
+			default: {
+				// Binary operators
+				LinkValue lhs = stack.back();
+				stack.pop_back();
+				if (lhs.section) {
+					return std::nullopt;
+				}
+				int32_t lval = lhs.value;
+				switch (command) {
+				case RPN_MUL:
+					value = static_cast<int32_t>(
+					    static_cast<uint32_t>(lval) * static_cast<uint32_t>(rval)
+					);
+					break;
+				case RPN_DIV:
+				case RPN_MOD:
+					if (rval == 0 || (lval == INT32_MIN && rval == -1)) {
+						return std::nullopt;
+					}
+					value = command == RPN_DIV ? op_divide(lval, rval) : op_modulo(lval, rval);
+					break;
+				case RPN_EXP:
+					if (rval < 0) {
+						return std::nullopt;
+					}
+					value = op_exponent(lval, rval);
+					break;
+				case RPN_OR:
+					value = lval | rval;
+					break;
+				case RPN_AND:
+					value = lval & rval;
+					break;
+				case RPN_XOR:
+					value = lval ^ rval;
+					break;
+				case RPN_LOGAND:
+					value = lval && rval;
+					break;
+				case RPN_LOGOR:
+					value = lval || rval;
+					break;
+				case RPN_LOGEQ:
+					value = lval == rval;
+					break;
+				case RPN_LOGNE:
+					value = lval != rval;
+					break;
+				case RPN_LOGGT:
+					value = lval > rval;
+					break;
+				case RPN_LOGLT:
+					value = lval < rval;
+					break;
+				case RPN_LOGGE:
+					value = lval >= rval;
+					break;
+				case RPN_LOGLE:
+					value = lval <= rval;
+					break;
+				case RPN_SHL:
+				case RPN_SHR:
+				case RPN_USHR:
+					if (rval < 0 || rval >= 32 || (command == RPN_SHR && lval < 0)) {
+						return std::nullopt;
+					}
+					value = command == RPN_SHL   ? op_shift_left(lval, rval)
+					        : command == RPN_SHR ? op_shift_right(lval, rval)
+					                             : op_shift_right_unsigned(lval, rval);
+					break;
+				// LCOV_EXCL_START
+				default:
+					return std::nullopt;
+				}
+				// LCOV_EXCL_STOP
+			}
+			}
+			operand = LinkValue{.value = value, .section = nullptr};
+			break;
+		}
+		}
+
+		if (!operand) {
+			return std::nullopt;
+		}
+		stack.push_back(*operand);
 	}
+
+	assume(stack.size() == 1);
+	return stack.back();
 }
 
-void out_WriteObject() {
-	if (!options.objectFileName) {
-		return;
+// Like `tryComputeLinkValue`, but only for values which do not depend on where rgblink places
+// floating sections
+static std::optional<int32_t>
+    tryComputeRPN(Patch const &patch, std::vector<uint8_t> const &rpnData) {
+	std::optional<LinkValue> value = tryComputeLinkValue(patch, rpnData);
+	if (!value || value->section) {
+		return std::nullopt;
 	}
+	return value->value;
+}
 
-	static FILE *file; // `static` so `sect_ForEach` callback can see it
-	char const *objectFileName = options.objectFileName->c_str();
-	if (*options.objectFileName != "-") {
-		file = fopen(objectFileName, "wb");
-	} else {
-		objectFileName = "<stdout>";
-		(void)setmode(STDOUT_FILENO, O_BINARY);
-		file = stdout;
+// Writes a patch's value into its section if it can be computed without any diagnostic
+static bool tryResolvePatch(Section &sect, Patch const &patch) {
+	if (patch.type == PATCHTYPE_JR) {
+		// A `jr` within a floating section only depends on the distance to its target
+		std::optional<LinkValue> target = tryComputeLinkValue(patch, sect.rpnData);
+		std::optional<LinkValue> pc = labelValue(patch.pcSection, patch.pcOffset);
+		if (!target || !pc || target->section != pc->section || patch.offset + 1 > sect.size) {
+			return false;
+		}
+		if (target->section) {
+			// Targets inside the section are within 16 bits wherever it is placed
+			if (target->value < 0
+			    || static_cast<uint32_t>(target->value) >= target->section->size) {
+				return false;
+			}
+		} else if (target->value < -(1 << 15) || target->value >= 1 << 16) {
+			return false;
+		}
+		// Offset is relative to the byte *after* the operand
+		// PC as operand to `jr` is lower than reference PC by 2
+		uint16_t address = pc->value + 2;
+		int16_t jumpOffset = static_cast<int16_t>(target->value - address);
+		if (jumpOffset < -128 || jumpOffset > 127) {
+			return false;
+		}
+		sect.data[patch.offset] = jumpOffset & 0xFF;
+		return true;
 	}
-	if (!file) {
-		// LCOV_EXCL_START
-		fatal("Failed to open object file \"%s\": %s", objectFileName, strerror(errno));
-		// LCOV_EXCL_STOP
+
+	std::optional<int32_t> value = tryComputeRPN(patch, sect.rpnData);
+	if (!value) {
+		return false;
 	}
-	Defer closeFile{[&] { xfclose(file); }};
+
+	uint8_t typeSize = patch.type == PATCHTYPE_BYTE ? 1 : patch.type == PATCHTYPE_WORD ? 2 : 4;
+	if (patch.offset + typeSize > sect.size
+	    || (typeSize < 4 && (*value < -(1 << (typeSize * 8 - 1)) || *value >= 1 << typeSize * 8))) {
+		return false;
+	}
+	for (uint8_t i = 0; i < typeSize; ++i) {
+		sect.data[patch.offset + i] = *value >> (i * 8);
+	}
+	return true;
+}
+
+// Patches and assertions which are already determined do not need rgblink to evaluate them
+static void resolveKnownPatches() {
+	static size_t nbPatches, nbResolved; // `static` so `sect_ForEach` callback can see them
+	nbPatches = 0;
+	nbResolved = 0;
+
+	sect_ForEach([](Section &sect) {
+		// Union members from other objects could overwrite the data, and fragments may move
+		if (!sectTypeHasData(sect.type) || sect.modifier != SECTION_NORMAL) {
+			nbPatches += sect.patches.size();
+			return;
+		}
+		std::deque<Patch> unresolved;
+		for (Patch const &patch : sect.patches) {
+			if (!tryResolvePatch(sect, patch)) {
+				unresolved.push_back(patch);
+			}
+		}
+		nbPatches += sect.patches.size();
+		nbResolved += sect.patches.size() - unresolved.size();
+		sect.patches = std::move(unresolved);
+	});
+
+	// Failing assertions are kept for rgblink to report
+	size_t nbAssertions = assertions.size();
+	std::erase_if(assertions, [](Assertion const &assert) {
+		std::optional<int32_t> value = tryComputeRPN(assert.patch, assertionRPNData);
+		return value && *value != 0;
+	});
+
+	verbosePrint(
+	    VERB_INFO,
+	    "Resolved %zu of %zu patches and %zu of %zu assertions\n",
+	    nbResolved,
+	    nbPatches,
+	    nbAssertions - assertions.size(),
+	    nbAssertions
+	);
+}
+
+// The compact object format stores numbers as unsigned LEB128
+static void putVarint(uint32_t n, std::vector<uint8_t> &buffer) {
+	for (; n >= 0x80; n >>= 7) {
+		buffer.push_back(n | 0x80);
+	}
+	buffer.push_back(n);
+}
+
+// IDs and addresses which may be `UINT32_MAX` are stored plus one, so that "none" is a single byte
+static void putOptionalVarint(uint32_t n, std::vector<uint8_t> &buffer) {
+	putVarint(n + 1, buffer);
+}
+
+// Signed values are zigzag-encoded, so that small negative values stay short
+static void putSignedVarint(int32_t n, std::vector<uint8_t> &buffer) {
+	putVarint(static_cast<uint32_t>(n) << 1 ^ static_cast<uint32_t>(n >> 31), buffer);
+}
+
+// Deduplicated strings or RPN expressions, referred to by index in the compact object format
+struct CompactPool {
+	std::unordered_map<std::string_view, uint32_t> indices;
+	std::vector<std::string_view> entries; // Views into data which outlives the serialization
+
+	uint32_t add(std::string_view entry) {
+		auto [it, inserted] = indices.try_emplace(entry, entries.size());
+		if (inserted) {
+			entries.push_back(entry);
+		}
+		return it->second;
+	}
+
+	uint32_t addString(std::string_view s) {
+		// Like `putString`, stop at any NUL char
+		return add(s.substr(0, s.find('\0')));
+	}
+
+	uint32_t addRPN(std::vector<uint8_t> const &rpnData, Patch const &patch) {
+		return add(std::string_view{
+		    reinterpret_cast<char const *>(rpnData.data()) + patch.rpnOfs, patch.rpnSize
+		});
+	}
+
+	void write(std::vector<uint8_t> &buffer) const {
+		putVarint(entries.size(), buffer);
+		for (std::string_view entry : entries) {
+			putVarint(entry.size(), buffer);
+			buffer.insert(buffer.end(), RANGE(entry));
+		}
+	}
+};
+
+static CompactPool compactStrings, compactRPNs;
+
+static void writeCompactPatch(
+    Patch const &patch, std::vector<uint8_t> const &rpnData, std::vector<uint8_t> &buffer
+) {
+	assume(patch.srcID != UINT32_MAX);
+
+	putVarint(patch.srcID, buffer);
+	putVarint(patch.lineNo, buffer);
+	putVarint(patch.offset, buffer);
+	putOptionalVarint(patch.pcSection ? patch.pcSection->getID() : UINT32_MAX, buffer);
+	putVarint(patch.pcOffset, buffer);
+	buffer.push_back(patch.type);
+	putVarint(compactRPNs.addRPN(rpnData, patch), buffer);
+}
+
+static void writeCompactSection(Section const &sect, std::vector<uint8_t> &buffer) {
+	assume(sect.src->ID != UINT32_MAX);
+
+	putVarint(compactStrings.addString(sect.name), buffer);
+	putVarint(sect.src->ID, buffer);
+	putVarint(sect.fileLine, buffer);
+	putVarint(sect.size, buffer);
+
+	assume((sect.type & SECTTYPE_TYPE_MASK) == sect.type);
+	bool isUnion = sect.modifier == SECTION_UNION;
+	bool isFragment = sect.modifier == SECTION_FRAGMENT;
+	buffer.push_back(sect.type | isUnion << SECTTYPE_UNION_BIT | isFragment << SECTTYPE_FRAGMENT_BIT);
+
+	putOptionalVarint(sect.org, buffer);
+	putOptionalVarint(sect.bank, buffer);
+	buffer.push_back(sect.align);
+	putVarint(sect.alignOfs, buffer);
+
+	if (sectTypeHasData(sect.type)) {
+		buffer.insert(buffer.end(), sect.data.begin(), sect.data.begin() + sect.size);
+		putVarint(sect.patches.size(), buffer);
+
+		for (Patch const &patch : sect.patches) {
+			writeCompactPatch(patch, sect.rpnData, buffer);
+		}
+	}
+}
+
+// Writes the opt-in compact object format (see `rgbds(5)`)
+static void serializeCompactObject(std::vector<uint8_t> &buffer) {
+	compactStrings = {};
+	compactRPNs = {};
+
+	// The string and RPN pools are only complete once everything else has been serialized
+	std::vector<uint8_t> body;
+
+	putVarint(fileStackNodes.size(), body);
+	putVarint(objectSymbols.size(), body);
+	putVarint(sect_CountSections(), body);
+	putVarint(assertions.size(), body);
+
+	for (std::shared_ptr<FileStackNode> const &node : fileStackNodes) {
+		putOptionalVarint(node->parent ? node->parent->ID : UINT32_MAX, body);
+		putVarint(node->lineNo, body);
+		body.push_back(node->type | node->isQuiet << FSTACKNODE_QUIET_BIT);
+		putVarint(
+		    node->type != NODE_REPT ? compactStrings.addString(node->name()) : node->iter(), body
+		);
+	}
+
+	for (Symbol const *sym : objectSymbols) {
+		putVarint(compactStrings.addString(sym->name.str()), body);
+		if (!sym->isDefined()) {
+			body.push_back(SYMTYPE_IMPORT);
+			continue;
+		}
+		assume(sym->src->ID != UINT32_MAX);
+
+		Section *symSection = sym->getSection();
+
+		body.push_back(sym->isExported ? SYMTYPE_EXPORT : SYMTYPE_LOCAL);
+		putVarint(sym->src->ID, body);
+		putVarint(sym->fileLine, body);
+		putOptionalVarint(symSection ? symSection->getID() : UINT32_MAX, body);
+		putSignedVarint(sym->getOutputValue(), body);
+	}
+
+	// Each section's offset is listed ahead of them, so that rgblink can seek to any of them
+	static std::vector<uint8_t> sectData; // `static` so `sect_ForEach` callback can see them
+	static std::vector<uint32_t> sectOffsets;
+	sectData.clear();
+	sectOffsets.clear();
+	sect_ForEach([](Section &sect) {
+		sectOffsets.push_back(sectData.size());
+		writeCompactSection(sect, sectData);
+	});
+	sectOffsets.push_back(sectData.size()); // The assertions follow the last section
+	for (uint32_t offset : sectOffsets) {
+		putVarint(offset, body);
+	}
+	body.insert(body.end(), RANGE(sectData));
+
+	for (Assertion const &assert : assertions) {
+		writeCompactPatch(assert.patch, assertionRPNData, body);
+		putVarint(compactStrings.addString(assert.message), body);
+	}
+
+	buffer.clear();
+	std::string_view version = RGBDS_COMPACT_OBJECT_VERSION_STRING;
+	buffer.insert(buffer.end(), RANGE(version));
+	putVarint(RGBDS_COMPACT_OBJECT_REV, buffer);
+	compactStrings.write(buffer);
+	compactRPNs.write(buffer);
+	buffer.insert(buffer.end(), RANGE(body));
+
+	verbosePrint(
+	    VERB_INFO,
+	    "Compact object: %zu unique strings, %zu unique RPN expressions\n",
+	    compactStrings.entries.size(),
+	    compactRPNs.entries.size()
+	);
+}
+
+void out_SerializeObject(std::vector<uint8_t> &buffer) {
+	resolveKnownPatches();
 
 	// Also write symbols that weren't written above
 	sym_ForEach(out_RegisterSymbol);
 
-	fputs(RGBDS_OBJECT_VERSION_STRING, file);
-	putLong(RGBDS_OBJECT_REV, file);
+	if (options.compactObject) {
+		serializeCompactObject(buffer);
+		return;
+	}
 
-	putLong(objectSymbols.size(), file);
-	putLong(sect_CountSections(), file);
+	// Reserve the buffer's size ahead of time, which is dominated by section data and patches
+	static size_t size; // `static` so `sect_ForEach` callback can see it
+	size = 4 + 4 * 4 + fileStackNodes.size() * 16 + objectSymbols.size() * 32;
+	sect_ForEach([](Section &sect) {
+		// Each patch takes 25 bytes besides its RPN
+		size += sect.name.length() + 23 + sect.size + 4 + sect.patches.size() * 25
+		        + sect.rpnData.size();
+	});
+	size += assertions.size() * 32 + assertionRPNData.size();
+	buffer.clear();
+	buffer.reserve(size);
 
-	putLong(fileStackNodes.size(), file);
+	std::string_view version = RGBDS_OBJECT_VERSION_STRING; // Not NUL-terminated in the file
+	buffer.insert(buffer.end(), RANGE(version));
+	putLong(RGBDS_OBJECT_REV, buffer);
+
+	putLong(objectSymbols.size(), buffer);
+	putLong(sect_CountSections(), buffer);
+
+	putLong(fileStackNodes.size(), buffer);
 	for (auto it = fileStackNodes.begin(); it != fileStackNodes.end(); ++it) {
-		writeFileStackNode(**it, file);
+		writeFileStackNode(**it, buffer);
 
 		// The list is supposed to have decrementing IDs
 		assume(it + 1 == fileStackNodes.end() || it[1]->ID == it[0]->ID - 1);
 	}
 
 	for (Symbol const *sym : objectSymbols) {
-		writeSymbol(*sym, file);
+		writeSymbol(*sym, buffer);
 	}
 
-	sect_ForEach([](Section &sect) { writeSection(sect, file); });
+	static std::vector<uint8_t> *sectBuffer; // `static` so `sect_ForEach` callback can see it
+	sectBuffer = &buffer;
+	sect_ForEach([](Section &sect) { writeSection(sect, *sectBuffer); });
 
-	putLong(assertions.size(), file);
+	putLong(assertions.size(), buffer);
 
 	for (Assertion const &assert : assertions) {
-		writeAssert(assert, file);
+		writeAssert(assert, buffer);
+	}
+}
+
+static bool writeBytes(int fd, uint8_t const *buf, size_t len) {
+	while (len) {
+		ssize_t ret = write(fd, buf, len);
+
+		// Return errors, unless we only were interrupted
+		if (ret == -1 && errno != EINTR) {
+			return false; // LCOV_EXCL_LINE
+		}
+		// If anything was written, continue with the rest
+		if (ret != -1) {
+			len -= ret;
+			buf += ret;
+		}
+	}
+	return true;
+}
+
+// Follows symbolic links (even dangling ones) to the path that they ultimately name
+static std::string resolveSymlinks(std::string const &fileName) {
+	std::filesystem::path path = fileName;
+	std::error_code ec;
+	// Give up on symbolic link loops like the OS would, instead of looping forever
+	for (int depth = 0; depth < 40 && std::filesystem::is_symlink(path, ec); ++depth) {
+		std::filesystem::path target = std::filesystem::read_symlink(path, ec);
+		if (ec) {
+			break; // LCOV_EXCL_LINE
+		}
+		path = target.is_absolute() ? target : path.parent_path() / target;
+	}
+	return path.string();
+}
+
+void out_WriteObject() {
+	if (!options.objectFileName) {
+		return;
+	}
+
+	std::vector<uint8_t> buffer;
+	out_SerializeObject(buffer);
+
+	if (*options.objectFileName == "-") {
+		(void)setmode(STDOUT_FILENO, O_BINARY);
+		if (!writeBytes(STDOUT_FILENO, buffer.data(), buffer.size())) {
+			// LCOV_EXCL_START
+			fatal("Failed to write object file \"<stdout>\": %s", strerror(errno));
+			// LCOV_EXCL_STOP
+		}
+		return;
+	}
+
+	// Diagnostics name the object file as given, even if it is written through a symbolic link
+	char const *objectFileName = options.objectFileName->c_str();
+	// Replace the target of a symbolic link, not the link itself
+	std::string targetFileName = resolveSymlinks(*options.objectFileName);
+
+	// Special files (e.g. "/dev/null" or a pipe) must be written to, not replaced
+	if (std::error_code ec; std::filesystem::exists(targetFileName, ec)
+	                        && !std::filesystem::is_regular_file(targetFileName, ec)) {
+		int fd = open(targetFileName.c_str(), O_WRONLY | O_BINARY);
+		if (fd == -1) {
+			// LCOV_EXCL_START
+			fatal("Failed to open object file \"%s\": %s", objectFileName, strerror(errno));
+			// LCOV_EXCL_STOP
+		}
+		bool written = writeBytes(fd, buffer.data(), buffer.size());
+		if (xclose(fd) != 0 || !written) {
+			// LCOV_EXCL_START
+			fatal("Failed to write object file \"%s\": %s", objectFileName, strerror(errno));
+			// LCOV_EXCL_STOP
+		}
+		return;
+	}
+
+	// Write to a temporary file which then replaces the object file, so that it is never seen
+	// half-written (e.g. by parallel build jobs); its name is unique to this process, so that
+	// concurrent jobs writing the same object file do not clobber each other's
+	std::string tmpFileName = targetFileName + '.' + std::to_string(getpid()) + ".tmp";
+	int fd = open(tmpFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+	if (fd == -1) {
+		// LCOV_EXCL_START
+		fatal("Failed to open object file \"%s\": %s", objectFileName, strerror(errno));
+		// LCOV_EXCL_STOP
+	}
+	bool written = writeBytes(fd, buffer.data(), buffer.size());
+	if (xclose(fd) != 0 || !written) {
+		// LCOV_EXCL_START
+		int err = errno;
+		remove(tmpFileName.c_str());
+		fatal("Failed to write object file \"%s\": %s", objectFileName, strerror(err));
+		// LCOV_EXCL_STOP
+	}
+
+	if (std::error_code ec; std::filesystem::rename(tmpFileName, targetFileName, ec), ec) {
+		// LCOV_EXCL_START
+		remove(tmpFileName.c_str());
+		fatal(
+		    "Failed to replace object file \"%s\": %s", objectFileName, ec.message().c_str()
+		);
+		// LCOV_EXCL_STOP
 	}
 }
 
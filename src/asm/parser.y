@@ -569,7 +569,7 @@ macro_args:
 	}
 	| macro_args STRING {
 		$$ = std::move($1);
-		$$->appendArg(std::make_shared<std::string>($2));
+		$$->appendArg($2);
 	}
 ;
 
@@ -25,9 +25,49 @@
 
 using namespace std::literals;
 
+std::string UnknownReason::str() const {
+	std::string reason;
+	switch (kind) {
+	case PC_NOT_CONSTANT:
+		reason = "PC is not constant at assembly time";
+		break;
+	case SYM_NOT_CONSTANT:
+		reason = "`"s + name.c_str() + "` is not constant at assembly time";
+		break;
+	case SYM_UNDEFINED:
+		reason = "undefined symbol `"s + name.c_str() + "`";
+		break;
+	case BANK_SELF:
+		reason = "Current section's bank is not known";
+		break;
+	case BANK_SYM:
+		reason = "`"s + name.c_str() + "`'s bank is not known";
+		break;
+	case BANK_SECT:
+		reason = "Section \""s + name.c_str() + "\"'s bank is not known";
+		break;
+	case SIZEOF_SECT:
+		reason = "Section \""s + name.c_str() + "\"'s size is not known";
+		break;
+	case STARTOF_SECT:
+		reason = "Section \""s + name.c_str() + "\"'s start is not known";
+		break;
+	case SIZEOF_SECTTYPE:
+		reason = "Section type's size is not known";
+		break;
+	case STARTOF_SECTTYPE:
+		reason = "Section type's start is not known";
+		break;
+	}
+	if (isPurged) {
+		reason.append("; it was purged");
+	}
+	return reason;
+}
+
 int32_t Expression::getConstVal() const {
 	if (!isKnown()) {
-		error("Expected constant expression: %s", std::get<std::string>(data).c_str());
+		error("Expected constant expression: %s", std::get<UnknownReason>(data).str().c_str());
 		return 0;
 	}
 	return value();
@@ -67,11 +107,13 @@ void Expression::makeSymbol(InternedStr symName) {
 		error("`%s` is not a numeric symbol", symName.c_str());
 		data = 0;
 	} else if (!sym || !sym->isConstant()) {
-		data = sym_IsPC(sym) ? "PC is not constant at assembly time"
-		                     : (sym && sym->isDefined()
-		                            ? "`"s + symName.str() + "` is not constant at assembly time"
-		                            : "undefined symbol `"s + symName.str() + "`")
-		                           + (sym_IsPurgedScoped(symName) ? "; it was purged" : "");
+		data = UnknownReason{
+		    .kind = sym_IsPC(sym)              ? UnknownReason::PC_NOT_CONSTANT
+		            : sym && sym->isDefined() ? UnknownReason::SYM_NOT_CONSTANT
+		                                      : UnknownReason::SYM_UNDEFINED,
+		    .isPurged = sym_IsPurgedScoped(symName),
+		    .name = symName,
+		};
 		sym = sym_Ref(symName);
 		rpn.emplace_back(RPN_SYM, sym->name);
 	} else {
@@ -87,7 +129,7 @@ void Expression::makeBankSymbol(InternedStr symName) {
 			error("PC has no bank outside of a section");
 			data = 1;
 		} else if (*outputBank == UINT32_MAX) {
-			data = "Current section's bank is not known";
+			data = UnknownReason{.kind = UnknownReason::BANK_SELF};
 			rpn.emplace_back(RPN_BANK_SELF);
 		} else {
 			data = static_cast<int32_t>(*outputBank);
@@ -102,9 +144,11 @@ void Expression::makeBankSymbol(InternedStr symName) {
 			// Symbol's section is known and bank is fixed
 			data = static_cast<int32_t>(sym->getSection()->bank);
 		} else {
-			data = sym_IsPurgedScoped(symName)
-			           ? "`"s + symName.str() + "`'s bank is not known; it was purged"
-			           : "`"s + symName.str() + "`'s bank is not known";
+			data = UnknownReason{
+			    .kind = UnknownReason::BANK_SYM,
+			    .isPurged = sym_IsPurgedScoped(symName),
+			    .name = symName,
+			};
 			rpn.emplace_back(RPN_BANK_SYM, sym->name);
 		}
 	}
@@ -115,8 +159,9 @@ void Expression::makeBankSection(std::string const &sectName) {
 	if (Section *sect = sect_FindSectionByName(sectName); sect && sect->bank != UINT32_MAX) {
 		data = static_cast<int32_t>(sect->bank);
 	} else {
-		data = "Section \""s + sectName + "\"'s bank is not known";
-		rpn.emplace_back(RPN_BANK_SECT, intern(sectName));
+		InternedStr name = intern(sectName);
+		data = UnknownReason{.kind = UnknownReason::BANK_SECT, .name = name};
+		rpn.emplace_back(RPN_BANK_SECT, name);
 	}
 }
 
@@ -125,8 +170,9 @@ void Expression::makeSizeOfSection(std::string const &sectName) {
 	if (Section *sect = sect_FindSectionByName(sectName); sect && sect->isSizeKnown()) {
 		data = static_cast<int32_t>(sect->size);
 	} else {
-		data = "Section \""s + sectName + "\"'s size is not known";
-		rpn.emplace_back(RPN_SIZEOF_SECT, intern(sectName));
+		InternedStr name = intern(sectName);
+		data = UnknownReason{.kind = UnknownReason::SIZEOF_SECT, .name = name};
+		rpn.emplace_back(RPN_SIZEOF_SECT, name);
 	}
 }
 
@@ -135,20 +181,21 @@ void Expression::makeStartOfSection(std::string const &sectName) {
 	if (Section *sect = sect_FindSectionByName(sectName); sect && sect->org != UINT32_MAX) {
 		data = static_cast<int32_t>(sect->org);
 	} else {
-		data = "Section \""s + sectName + "\"'s start is not known";
-		rpn.emplace_back(RPN_STARTOF_SECT, intern(sectName));
+		InternedStr name = intern(sectName);
+		data = UnknownReason{.kind = UnknownReason::STARTOF_SECT, .name = name};
+		rpn.emplace_back(RPN_STARTOF_SECT, name);
 	}
 }
 
 void Expression::makeSizeOfSectionType(SectionType type) {
 	assume(rpn.empty());
-	data = "Section type's size is not known";
+	data = UnknownReason{.kind = UnknownReason::SIZEOF_SECTTYPE};
 	rpn.emplace_back(RPN_SIZEOF_SECTTYPE, static_cast<uint8_t>(type));
 }
 
 void Expression::makeStartOfSectionType(SectionType type) {
 	assume(rpn.empty());
-	data = "Section type's start is not known";
+	data = UnknownReason{.kind = UnknownReason::STARTOF_SECTTYPE};
 	rpn.emplace_back(RPN_STARTOF_SECTTYPE, static_cast<uint8_t>(type));
 }
 
@@ -284,7 +331,7 @@ void Expression::makeUnaryOp(RPNCommand op, Expression &&src) {
 	} else if (int32_t constVal; op == RPN_LOW && (constVal = tryConstLow(src)) != -1) {
 		data = constVal;
 	} else {
-		// If it's not known, just reuse its RPN vector and append the operator
+		// If it's not known, just reuse its RPN values and append the operator
 		data = std::move(src.data);
 		std::swap(rpn, src.rpn);
 		rpn.emplace_back(op);
@@ -427,7 +474,7 @@ void Expression::makeBinaryOp(RPNCommand op, Expression &&src1, Expression const
 			data = std::move(src2.data);
 			rpn.emplace_back(RPN_CONST, lval);
 		} else {
-			// Otherwise just reuse its RPN vector
+			// Otherwise just reuse its RPN values
 			data = std::move(src1.data);
 			std::swap(rpn, src1.rpn);
 		}
@@ -438,8 +485,8 @@ void Expression::makeBinaryOp(RPNCommand op, Expression &&src1, Expression const
 			uint32_t rval = src2.value();
 			rpn.emplace_back(RPN_CONST, rval);
 		} else {
-			// Otherwise just extend with its RPN vector
-			rpn.insert(rpn.end(), RANGE(src2.rpn));
+			// Otherwise just extend with its RPN values
+			rpn.append(src2.rpn);
 		}
 		// Append the operator
 		rpn.emplace_back(op);
@@ -513,20 +560,19 @@ bool checkNBit(int32_t v, uint8_t n, char const *name) {
 }
 
 void Expression::encode(std::vector<uint8_t> &buffer) const {
-	assume(buffer.empty());
-
 	if (isKnown()) {
 		// If the RPN expression's value is known, output a constant directly
 		uint32_t val = value();
-		buffer.resize(5);
-		buffer[0] = RPN_CONST;
-		buffer[1] = val & 0xFF;
-		buffer[2] = val >> 8;
-		buffer[3] = val >> 16;
-		buffer[4] = val >> 24;
+		buffer.insert(
+		    buffer.end(),
+		    {RPN_CONST,
+		     static_cast<uint8_t>(val),
+		     static_cast<uint8_t>(val >> 8),
+		     static_cast<uint8_t>(val >> 16),
+		     static_cast<uint8_t>(val >> 24)}
+		);
 	} else {
 		// If the RPN expression's value is not known, serialize its RPN values
-		buffer.reserve(rpn.size() * 2); // Rough estimate of the serialized size
 		for (RPNValue const &val : rpn) {
 			val.appendEncoded(buffer);
 		}
@@ -591,8 +637,7 @@ void RPNValue::appendEncoded(std::vector<uint8_t> &buffer) const {
 	case RPN_STARTOF_SECT: {
 		// The command ID is followed by a NUL-terminated section name string
 		assume(std::holds_alternative<InternedStr>(data));
-		std::string const &name = std::get<InternedStr>(data).str();
-		buffer.reserve(buffer.size() + name.length() + 1);
+		std::string_view name = std::get<InternedStr>(data).str();
 		buffer.insert(buffer.end(), RANGE(name));
 		buffer.push_back('\0');
 		break;
@@ -640,8 +640,8 @@ std::optional<uint32_t> sect_GetOutputBank() {
 	return currentSection ? std::optional<uint32_t>(currentSection->bank) : std::nullopt;
 }
 
-Patch *sect_AddOutputPatch() {
-	return currentSection ? &currentSection->patches.emplace_front() : nullptr;
+Section *sect_GetOutputSection() {
+	return currentSection;
 }
 
 // Returns how many bytes need outputting for the specified alignment and offset to succeed
@@ -735,6 +735,39 @@ static void writeByte(uint8_t byte) {
 	growSection(1);
 }
 
+// Grows the section by `size` bytes, and returns the part of them which fits in its data
+static std::pair<uint8_t *, size_t> emitBytes(size_t size) {
+	if (size > UINT32_MAX) {
+		fatal("Section size would overflow internal counter");
+	}
+	uint32_t index = sect_GetOutputOffset();
+	growSection(size);
+	if (index >= currentSection->data.size()) {
+		return {nullptr, 0};
+	}
+	return {&currentSection->data[index], std::min(size, currentSection->data.size() - index)};
+}
+
+static void writeBytes(char const *bytes, size_t size) {
+	if (auto [dest, nbEmitted] = emitBytes(size); nbEmitted) {
+		memcpy(dest, bytes, nbEmitted);
+	}
+}
+
+static void fillBytes(uint8_t byte, size_t size) {
+	if (auto [dest, nbEmitted] = emitBytes(size); nbEmitted) {
+		memset(dest, byte, nbEmitted);
+	}
+}
+
+// Writes each unit as `width` little-endian bytes
+static void writeUnits(std::vector<int32_t> const &units, size_t width) {
+	auto [dest, nbEmitted] = emitBytes(units.size() * width);
+	for (size_t i = 0; i < nbEmitted; ++i) {
+		dest[i] = static_cast<uint32_t>(units[i / width]) >> (i % width * 8);
+	}
+}
+
 static void writeWord(uint16_t value) {
 	writeByte(value & 0xFF);
 	writeByte(value >> 8);
@@ -822,9 +855,7 @@ void sect_ByteString(std::vector<int32_t> const &str) {
 		}
 	}
 
-	for (int32_t unit : str) {
-		writeByte(static_cast<uint8_t>(unit));
-	}
+	writeUnits(str, 1);
 }
 
 void sect_WordString(std::vector<int32_t> const &str) {
@@ -838,9 +869,7 @@ void sect_WordString(std::vector<int32_t> const &str) {
 		}
 	}
 
-	for (int32_t unit : str) {
-		writeWord(static_cast<uint16_t>(unit));
-	}
+	writeUnits(str, 2);
 }
 
 void sect_LongString(std::vector<int32_t> const &str) {
@@ -848,9 +877,7 @@ void sect_LongString(std::vector<int32_t> const &str) {
 		return;
 	}
 
-	for (int32_t unit : str) {
-		writeLong(static_cast<uint32_t>(unit));
-	}
+	writeUnits(str, 4);
 }
 
 void sect_Skip(uint32_t skip, bool ds) {
@@ -871,9 +898,7 @@ void sect_Skip(uint32_t skip, bool ds) {
 			);
 		}
 		// We know we're in a code SECTION
-		while (skip--) {
-			writeByte(options.padByte);
-		}
+		fillBytes(options.padByte, skip);
 	}
 }
 
@@ -895,6 +920,15 @@ void sect_RelBytes(uint32_t n, std::vector<Expression> const &exprs) {
 		return;
 	}
 
+	// Constant values can all be emitted at once, without any patches
+	if (std::all_of(RANGE(exprs), [](Expression const &expr) { return expr.isKnown(); })) {
+		auto [dest, nbEmitted] = emitBytes(n);
+		for (size_t i = 0; i < nbEmitted; ++i) {
+			dest[i] = exprs[i % exprs.size()].value();
+		}
+		return;
+	}
+
 	for (uint32_t i = 0; i < n; ++i) {
 		if (Expression const &expr = exprs[i % exprs.size()]; !expr.isKnown()) {
 			createPatch(PATCHTYPE_BYTE, expr, i);
@@ -964,20 +998,9 @@ void sect_PCRelByte(Expression const &expr, uint32_t pcShift) {
 	}
 }
 
-bool sect_BinaryFile(std::string const &name, uint32_t startPos) {
-	if (!requireCodeSection()) {
-		return false;
-	}
-
-	FILE *file = nullptr;
-	if (std::optional<std::string> fullPath = fstk_FindFile(name); fullPath) {
-		file = fopen(fullPath->c_str(), "rb");
-	}
-	if (!file) {
-		return fstk_FileError(name, "`INCBIN`");
-	}
-	Defer closeFile{[&] { xfclose(file); }};
-
+// Skips to the start position of an `INCBIN` file which could not be loaded whole
+// LCOV_EXCL_START
+static bool skipToStartPos(FILE *file, std::string const &name, uint32_t startPos) {
 	if (std::optional<uint64_t> fileSize = seekSize(file); fileSize.has_value()) {
 		if (startPos > *fileSize) {
 			error(
@@ -992,7 +1015,6 @@ bool sect_BinaryFile(std::string const &name, uint32_t startPos) {
 		// The file is seekable; skip to the specified start position
 		fseek(file, startPos, SEEK_SET);
 	} else {
-		// LCOV_EXCL_START
 		if (errno != ESPIPE) {
 			error(
 			    "Error determining size of `INCBIN` file \"%s\": %s", name.c_str(), strerror(errno)
@@ -1007,18 +1029,59 @@ bool sect_BinaryFile(std::string const &name, uint32_t startPos) {
 				return false;
 			}
 		}
-		// LCOV_EXCL_STOP
+	}
+	return true;
+}
+// LCOV_EXCL_STOP
+
+bool sect_BinaryFile(std::string const &name, uint32_t startPos) {
+	if (!requireCodeSection()) {
+		return false;
+	}
+
+	std::optional<std::string> fullPath = fstk_FindFile(name);
+	if (!fullPath) {
+		return fstk_FileError(name, "`INCBIN`");
+	}
+
+	// Regular files are loaded whole (and cached), so the data can be appended in bulk
+	if (std::optional<ContentSpan> content = lexer_LoadFile(*fullPath); content) {
+		if (startPos > content->size) {
+			error(
+			    "Specified start position (%" PRIu32 ") is greater than length of \"%s\" (%zu)",
+			    startPos,
+			    name.c_str(),
+			    content->size
+			);
+			return false;
+		}
+		if (startPos == content->size) { // Empty files have no content to point into
+			return false;
+		}
+		writeBytes(&content->ptr[startPos], content->size - startPos);
+		return false;
+	}
+
+	// LCOV_EXCL_START
+	FILE *file = fopen(fullPath->c_str(), "rb");
+	if (!file) {
+		return fstk_FileError(name, "`INCBIN`");
+	}
+	Defer closeFile{[&] { xfclose(file); }};
+
+	if (!skipToStartPos(file, name, startPos)) {
+		return false;
 	}
 
-	for (int byte; (byte = fgetc(file)) != EOF;) {
-		writeByte(byte);
+	char buf[BUFSIZ];
+	for (size_t nbRead; (nbRead = fread(buf, 1, sizeof(buf), file)) != 0;) {
+		writeBytes(buf, nbRead);
 	}
 
 	if (ferror(file)) {
-		// LCOV_EXCL_START
 		error("Error reading `INCBIN` file \"%s\": %s", name.c_str(), strerror(errno));
-		// LCOV_EXCL_STOP
 	}
+	// LCOV_EXCL_STOP
 	return false;
 }
 
@@ -1030,72 +1093,66 @@ bool sect_BinaryFileSlice(std::string const &name, uint32_t startPos, uint32_t l
 		return false;
 	}
 
-	FILE *file = nullptr;
-	if (std::optional<std::string> fullPath = fstk_FindFile(name); fullPath) {
-		file = fopen(fullPath->c_str(), "rb");
-	}
-	if (!file) {
+	std::optional<std::string> fullPath = fstk_FindFile(name);
+	if (!fullPath) {
 		return fstk_FileError(name, "`INCBIN`");
 	}
-	Defer closeFile{[&] { xfclose(file); }};
 
-	if (std::optional<uint64_t> fileSize = seekSize(file); fileSize.has_value()) {
-		if (startPos > *fileSize) {
+	// Regular files are loaded whole (and cached), so the data can be appended in bulk
+	if (std::optional<ContentSpan> content = lexer_LoadFile(*fullPath); content) {
+		if (startPos > content->size) {
 			error(
-			    "Specified start position (%" PRIu32 ") is greater than length of \"%s\" (%" PRIu64
-			    ")",
+			    "Specified start position (%" PRIu32 ") is greater than length of \"%s\" (%zu)",
 			    startPos,
 			    name.c_str(),
-			    *fileSize
+			    content->size
 			);
 			return false;
-		} else if (startPos + length > *fileSize) {
+		} else if (length > content->size - startPos) {
 			error(
 			    "Specified range in `INCBIN` file \"%s\" is out of bounds (%" PRIu32 " + %" PRIu32
-			    " > %" PRIu64 ")",
+			    " > %zu)",
 			    name.c_str(),
 			    startPos,
 			    length,
-			    *fileSize
+			    content->size
 			);
 			return false;
 		}
-		// The file is seekable; skip to the specified start position
-		fseek(file, startPos, SEEK_SET);
-	} else {
-		// LCOV_EXCL_START
-		if (errno != ESPIPE) {
-			error(
-			    "Error determining size of `INCBIN` file \"%s\": %s", name.c_str(), strerror(errno)
-			);
-		}
-		// The file isn't seekable, so we'll just skip bytes one at a time
-		while (startPos--) {
-			if (fgetc(file) == EOF) {
+		writeBytes(&content->ptr[startPos], length);
+		return false;
+	}
+
+	// LCOV_EXCL_START
+	FILE *file = fopen(fullPath->c_str(), "rb");
+	if (!file) {
+		return fstk_FileError(name, "`INCBIN`");
+	}
+	Defer closeFile{[&] { xfclose(file); }};
+
+	if (!skipToStartPos(file, name, startPos)) {
+		return false;
+	}
+
+	char buf[BUFSIZ];
+	while (length) {
+		size_t nbRead = fread(buf, 1, std::min<size_t>(length, sizeof(buf)), file);
+		if (nbRead == 0) {
+			if (ferror(file)) {
+				error("Error reading `INCBIN` file \"%s\": %s", name.c_str(), strerror(errno));
+			} else {
 				error(
-				    "Specified start position is greater than length of file \"%s\"", name.c_str()
+				    "Premature end of `INCBIN` file \"%s\" (%" PRIu32 " bytes left to read)",
+				    name.c_str(),
+				    length
 				);
-				return false;
 			}
+			break;
 		}
-		// LCOV_EXCL_STOP
-	}
-
-	while (length--) {
-		if (int byte = fgetc(file); byte != EOF) {
-			writeByte(byte);
-			// LCOV_EXCL_START
-		} else if (ferror(file)) {
-			error("Error reading `INCBIN` file \"%s\": %s", name.c_str(), strerror(errno));
-		} else {
-			error(
-			    "Premature end of `INCBIN` file \"%s\" (%" PRId32 " bytes left to read)",
-			    name.c_str(),
-			    length + 1
-			);
-			// LCOV_EXCL_STOP
-		}
+		writeBytes(buf, nbRead);
+		length -= nbRead;
 	}
+	// LCOV_EXCL_STOP
 	return false;
 }
 
@@ -3,18 +3,21 @@
 #include "asm/symbol.hpp"
 
 #include <algorithm>
+#include <deque>
 #include <errno.h>
 #include <inttypes.h>
 #include <memory>
+#include <optional>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <string>
+#include <string_view>
 #include <time.h>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "diagnostics.hpp"
 #include "helpers.hpp" // assume
@@ -30,10 +33,48 @@
 #include "asm/section.hpp"
 #include "asm/warning.hpp"
 
-using namespace std::literals;
+// Symbols are stored in pages indexed by the interning order of their names,
+// so that finding one is just an array access, and they never move in memory
+struct SymbolSlot {
+	std::optional<Symbol> sym;
+	bool purged = false; // A tombstone left by `PURGE`
+};
 
-static std::unordered_map<InternedStr, Symbol> symbols;
-static std::unordered_set<InternedStr> purgedSymbols;
+static constexpr size_t SYMBOL_PAGE_SIZE = 256;
+static std::vector<std::unique_ptr<SymbolSlot[]>> symbolPages;
+
+// Anonymous labels are stored apart, indexed by their ID, since their names are not interned
+static std::deque<SymbolSlot> anonLabelSlots;
+
+static SymbolSlot *findSlot(InternedStr symName) {
+	if (symName.isAnonLabel()) {
+		uint32_t id = symName.anonLabelID();
+		return id < anonLabelSlots.size() ? &anonLabelSlots[id] : nullptr;
+	}
+	size_t page = symName.index() / SYMBOL_PAGE_SIZE;
+	if (page >= symbolPages.size() || !symbolPages[page]) {
+		return nullptr;
+	}
+	return &symbolPages[page][symName.index() % SYMBOL_PAGE_SIZE];
+}
+
+static SymbolSlot &getSlot(InternedStr symName) {
+	if (symName.isAnonLabel()) {
+		uint32_t id = symName.anonLabelID();
+		if (id >= anonLabelSlots.size()) {
+			anonLabelSlots.resize(id + 1); // Growing a deque does not move its elements
+		}
+		return anonLabelSlots[id];
+	}
+	size_t page = symName.index() / SYMBOL_PAGE_SIZE;
+	if (page >= symbolPages.size()) {
+		symbolPages.resize(page + 1);
+	}
+	if (!symbolPages[page]) {
+		symbolPages[page] = std::make_unique<SymbolSlot[]>(SYMBOL_PAGE_SIZE);
+	}
+	return symbolPages[page][symName.index() % SYMBOL_PAGE_SIZE];
+}
 
 static Symbol const *globalScope = nullptr; // Current section's global label scope
 static Symbol const *localScope = nullptr;  // Current section's local label scope
@@ -65,8 +106,20 @@ bool sym_IsDotScope(InternedStr symName) {
 }
 
 void sym_ForEach(void (*callback)(Symbol &)) {
-	for (auto &it : symbols) {
-		callback(it.second);
+	for (std::unique_ptr<SymbolSlot[]> const &page : symbolPages) {
+		if (!page) {
+			continue;
+		}
+		for (size_t i = 0; i < SYMBOL_PAGE_SIZE; ++i) {
+			if (std::optional<Symbol> &sym = page[i].sym; sym) {
+				callback(*sym);
+			}
+		}
+	}
+	for (SymbolSlot &slot : anonLabelSlots) {
+		if (slot.sym) {
+			callback(*slot.sym);
+		}
 	}
 }
 
@@ -235,7 +288,11 @@ static Symbol &createSymbol(InternedStr symName) {
 
 	static uint32_t nextDefIndex = 0;
 
-	Symbol &sym = symbols[symName];
+	std::optional<Symbol> &slotSym = getSlot(symName).sym;
+	if (!slotSym) {
+		slotSym.emplace();
+	}
+	Symbol &sym = *slotSym;
 
 	sym.name = symName;
 	sym.isBuiltin = false;
@@ -252,14 +309,14 @@ static Symbol &createSymbol(InternedStr symName) {
 
 static bool isAutoScoped(InternedStr symName) {
 	// `globalScope` should be global if it's defined
-	assume(!globalScope || globalScope->name.str().find('.') == std::string::npos);
+	assume(!globalScope || globalScope->name.dotPos() == std::string_view::npos);
 	// `localScope` should be qualified local if it's defined
-	assume(!localScope || localScope->name.str().find('.') != std::string::npos);
+	assume(!localScope || localScope->name.dotPos() != std::string_view::npos);
 
-	size_t dotPos = symName.str().find('.');
+	size_t dotPos = symName.dotPos();
 
 	// If there are no dots, it's not a local label
-	if (dotPos == std::string::npos) {
+	if (dotPos == std::string_view::npos) {
 		return false;
 	}
 
@@ -274,7 +331,7 @@ static bool isAutoScoped(InternedStr symName) {
 	}
 
 	// Check for more than one dot
-	if (symName.str().find('.', dotPos + 1) != std::string::npos) {
+	if (symName.hasNestedDot()) {
 		fatal("`%s` is a nonsensical reference to a nested local label", symName.c_str());
 	}
 
@@ -291,15 +348,35 @@ static bool isAutoScoped(InternedStr symName) {
 	return true;
 }
 
+// Qualified names of the local labels referenced in the current global scope, so that each
+// reference does not build and intern the qualified name again
+static InternedStr qualifiedScopeName;
+static std::unordered_map<InternedStr, InternedStr> qualifiedNames;
+
 static InternedStr expandedSymName(InternedStr symName) {
-	return isAutoScoped(symName) ? intern(globalScope->name.str() + symName.str()) : symName;
+	if (!isAutoScoped(symName)) {
+		return symName;
+	}
+
+	// Scopes are compared by name, since a purged scope's symbol may be reused by another one
+	if (globalScope->name != qualifiedScopeName) {
+		qualifiedScopeName = globalScope->name;
+		qualifiedNames.clear();
+	}
+	auto [it, inserted] = qualifiedNames.try_emplace(symName);
+	if (inserted) {
+		std::string qualifiedName{globalScope->name.str()};
+		qualifiedName.append(symName.str());
+		it->second = intern(qualifiedName);
+	}
+	return it->second;
 }
 
 Symbol *sym_FindExactSymbol(InternedStr symName) {
 	assumeAlreadyExpanded(symName);
 
-	auto search = symbols.find(symName);
-	return search != symbols.end() ? &search->second : nullptr;
+	SymbolSlot *slot = findSlot(symName);
+	return slot && slot->sym ? &*slot->sym : nullptr;
 }
 
 Symbol *sym_FindScopedSymbol(InternedStr symName) {
@@ -363,15 +440,17 @@ void sym_Purge(InternedStr symName) {
 		if (sym == localScope) {
 			localScope = nullptr;
 		}
-		purgedSymbols.emplace(sym->name);
-		symbols.erase(sym->name);
+		SymbolSlot &slot = getSlot(sym->name);
+		slot.purged = true;
+		slot.sym.reset();
 	}
 }
 
 bool sym_IsPurgedExact(InternedStr symName) {
 	assumeAlreadyExpanded(symName);
 
-	return purgedSymbols.find(symName) != purgedSymbols.end();
+	SymbolSlot const *slot = findSlot(symName);
+	return slot && slot->purged;
 }
 
 bool sym_IsPurgedScoped(InternedStr symName) {
@@ -410,9 +489,9 @@ void sym_SetCurrentLabelScopes(std::pair<Symbol const *, Symbol const *> newScop
 	localScope = std::get<1>(newScopes);
 
 	// `globalScope` should be global if it's defined
-	assume(!globalScope || globalScope->name.str().find('.') == std::string::npos);
+	assume(!globalScope || globalScope->name.dotPos() == std::string_view::npos);
 	// `localScope` should be qualified local if it's defined
-	assume(!localScope || localScope->name.str().find('.') != std::string::npos);
+	assume(!localScope || localScope->name.dotPos() != std::string_view::npos);
 }
 
 void sym_ResetCurrentLabelScopes() {
@@ -425,7 +504,7 @@ static Symbol *createNonrelocSymbol(InternedStr symName, bool numeric) {
 
 	if (!sym) {
 		sym = &createSymbol(symName);
-		purgedSymbols.erase(sym->name);
+		getSlot(sym->name).purged = false;
 	} else if (sym->isDefined()) {
 		alreadyDefinedError(*sym, nullptr);
 		return nullptr; // Don't allow overriding the symbol, that'd be bad!
@@ -558,7 +637,7 @@ static Symbol *addLabel(InternedStr symName) {
 	sym->type = SYM_LABEL;
 	sym->data = static_cast<int32_t>(sect_GetSymbolOffset());
 	// Don't export anonymous labels
-	if (options.exportAll && !symName.str().starts_with('!')) {
+	if (options.exportAll && !symName.isAnonLabel()) {
 		sym->isExported = true;
 	}
 	sym->section = section;
@@ -568,7 +647,7 @@ static Symbol *addLabel(InternedStr symName) {
 
 Symbol *sym_AddLocalLabel(InternedStr symName) {
 	// The symbol name should be local, qualified or not
-	assume(symName.str().find('.') != std::string::npos);
+	assume(symName.dotPos() != std::string_view::npos);
 
 	Symbol *sym = addLabel(expandedSymName(symName));
 
@@ -581,7 +660,7 @@ Symbol *sym_AddLocalLabel(InternedStr symName) {
 
 Symbol *sym_AddLabel(InternedStr symName) {
 	// The symbol name should be global
-	assume(symName.str().find('.') == std::string::npos);
+	assume(symName.dotPos() == std::string_view::npos);
 
 	Symbol *sym = addLabel(symName);
 
@@ -640,11 +719,11 @@ InternedStr sym_MakeAnonLabelName(uint32_t ofs, bool neg) {
 		}
 	}
 
-	return intern("!"s + std::to_string(id));
+	return InternedStr::anonLabel(id);
 }
 
 void sym_Export(InternedStr symName) {
-	if (symName.str().starts_with('!')) {
+	if (symName.isAnonLabel()) {
 		// LCOV_EXCL_START
 		// The parser does not accept anonymous labels for an `EXPORT` directive
 		error("Cannot export anonymous label");
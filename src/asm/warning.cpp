@@ -5,6 +5,7 @@
 #include <functional>
 #include <inttypes.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -61,6 +62,8 @@ Diagnostics<WarningLevel, WarningID> warnings = {
 };
 // clang-format on
 
+uint64_t nbDiagnostics = 0;
+
 static void incrementErrors() {
 	// This intentionally makes 0 act as "unlimited"
 	warnings.incrementErrors();
@@ -80,6 +83,8 @@ static void incrementErrors() {
 }
 
 void error(char const *fmt, ...) {
+	++nbDiagnostics;
+
 	va_list args;
 	va_start(args, fmt);
 	verrorx(fmt, args);
@@ -90,6 +95,8 @@ void error(char const *fmt, ...) {
 }
 
 void errorNoTrace(std::function<void()> callback) {
+	++nbDiagnostics;
+
 	style_Set(stderr, STYLE_RED, true);
 	fputs("error: ", stderr);
 	style_Reset(stderr);
@@ -134,6 +141,8 @@ void requireZeroErrors() {
 }
 
 void warning(WarningID id, char const *fmt, ...) {
+	++nbDiagnostics;
+
 	va_list args;
 	va_start(args, fmt);
 	WarningBehavior behavior = printDiagnostic(warnings, id, fmt, args);
@@ -40,13 +40,11 @@ void FileStackNode::printBacktrace(uint32_t curLineNo) const {
 	std::vector<TraceNode> traceNodes;
 	traceNodes.reserve(items.size());
 	for (auto &[node, itemLineNo] : reversed(items)) {
-		if (std::holds_alternative<std::vector<uint32_t>>(node->data)) {
+		if (std::holds_alternative<uint32_t>(node->data)) {
 			assume(!traceNodes.empty()); // REPT nodes use their parent's name
 			std::string reptName = traceNodes.back().first;
-			if (std::vector<uint32_t> const &nodeIters = node->iters(); !nodeIters.empty()) {
-				reptName.append(NODE_SEPARATOR REPT_NODE_PREFIX);
-				reptName.append(std::to_string(nodeIters.back()));
-			}
+			reptName.append(NODE_SEPARATOR REPT_NODE_PREFIX);
+			reptName.append(std::to_string(node->iter()));
 			traceNodes.emplace_back(reptName, itemLineNo);
 		} else {
 			traceNodes.emplace_back(node->name(), itemLineNo);
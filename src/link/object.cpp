@@ -2,6 +2,7 @@
 
 #include "link/object.hpp"
 
+#include <algorithm>
 #include <deque>
 #include <errno.h>
 #include <inttypes.h>
@@ -12,6 +13,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -121,21 +123,10 @@ static void readFileStackNode(
 		break;
 	case NODE_REPT: {
 		node.type = NODE_REPT;
-		uint32_t depth;
+		node.data = uint32_t{0};
 		tryReadLong(
-		    depth, file, "%s: Cannot read node #%" PRIu32 "'s REPT depth: %s", fileName, nodeID
+		    node.iter(), file, "%s: Cannot read node #%" PRIu32 "'s REPT iter: %s", fileName, nodeID
 		);
-		node.data = std::vector<uint32_t>(depth);
-		for (uint32_t i = 0; i < depth; ++i) {
-			tryReadLong(
-			    node.iters()[i],
-			    file,
-			    "%s: Cannot read node #%" PRIu32 "'s iter #%" PRIu32 ": %s",
-			    fileName,
-			    nodeID,
-			    i
-			);
-		}
 		if (!node.parent) {
 			fatal(
 			    "%s: Invalid object file: root node (#%" PRIu32 ") may not be REPT",
@@ -429,6 +420,458 @@ static void readAssertion(
 	tryReadString(assert.message, file, "%s: Cannot read assertion's message: %s", fileName);
 }
 
+// Links a file's patches and symbols to its sections, then adds them to the rest.
+static void linkFileSections(
+    std::vector<Symbol> &fileSymbols,
+    std::vector<std::unique_ptr<Section>> &fileSections,
+    char const *fileName
+) {
+	// Give patches' PC section pointers to their sections
+	for (std::unique_ptr<Section> const &sect : fileSections) {
+		if (!sectTypeHasData(sect->type)) {
+			continue;
+		}
+		for (size_t i = 0; i < sect->patches.size(); ++i) {
+			if (Patch &patch = sect->patches[i]; patch.pcSectionID == UINT32_MAX) {
+				patch.pcSection = nullptr;
+			} else if (patch.pcSectionID >= fileSections.size()) {
+				fatal(
+				    "%s: \"%s\"'s patch #%zu has invalid section ID #%" PRIu32,
+				    fileName,
+				    sect->name.c_str(),
+				    i,
+				    patch.pcSectionID
+				);
+			} else {
+				patch.pcSection = fileSections[patch.pcSectionID].get();
+			}
+		}
+	}
+
+	// Give symbols' section pointers to their sections
+	for (Symbol &sym : fileSymbols) {
+		if (std::holds_alternative<Label>(sym.data)) {
+			sym.linkToSection(*fileSections[std::get<Label>(sym.data).sectionID]);
+		}
+	}
+
+	// Calling `sect_AddSection` invalidates the contents of `fileSections`!
+	for (std::unique_ptr<Section> &sect : fileSections) {
+		sect_AddSection(std::move(sect));
+	}
+
+	// Fix symbols' section pointers to section "pieces"
+	// This has to run **after** all the `sect_AddSection()` calls,
+	// so that `sect_GetSection()` will work
+	for (Symbol &sym : fileSymbols) {
+		sym.fixSectionOffset();
+	}
+}
+
+// Reads an in-memory compact object file, checking every read against its end
+class CompactReader {
+	uint8_t const *ptr;
+	uint8_t const *end;
+	char const *fileName;
+	std::vector<std::string_view> strings;
+	std::vector<std::string_view> rpnExpressions;
+
+	[[noreturn]] void truncated(char const *what) {
+		fatal("%s: Cannot read %s: Unexpected end of file", fileName, what);
+	}
+
+	std::vector<std::string_view> readPool(char const *what) {
+		std::vector<std::string_view> pool(readVarint(what));
+		for (std::string_view &entry : pool) {
+			entry = readBytes(readVarint(what), what);
+		}
+		return pool;
+	}
+
+public:
+	CompactReader(std::vector<uint8_t> const &contents, char const *fileName_)
+	    : ptr(contents.data()), end(contents.data() + contents.size()), fileName(fileName_) {}
+
+	uint8_t const *pos() const { return ptr; }
+
+	void seek(uint8_t const *base, uint32_t offset, char const *what) {
+		if (offset > static_cast<size_t>(end - base)) {
+			truncated(what);
+		}
+		ptr = base + offset;
+	}
+
+	uint8_t readByte(char const *what) {
+		if (ptr == end) {
+			truncated(what);
+		}
+		return *ptr++;
+	}
+
+	// Numbers are stored as unsigned LEB128
+	uint32_t readVarint(char const *what) {
+		uint32_t value = 0;
+		for (uint8_t shift = 0;; shift += 7) {
+			uint8_t byte = readByte(what);
+			if (shift == 28 && byte > 0x0F) {
+				fatal("%s: Invalid %s: value does not fit in 32 bits", fileName, what);
+			}
+			value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) {
+				return value;
+			}
+		}
+	}
+
+	// IDs and addresses which may be `UINT32_MAX` are stored plus one
+	uint32_t readOptionalVarint(char const *what) { return readVarint(what) - 1; }
+
+	// Signed values are zigzag-encoded
+	int32_t readSignedVarint(char const *what) {
+		uint32_t value = readVarint(what);
+		return static_cast<int32_t>(value >> 1 ^ -(value & 1));
+	}
+
+	std::string_view readBytes(uint32_t size, char const *what) {
+		if (size > static_cast<size_t>(end - ptr)) {
+			truncated(what);
+		}
+		std::string_view bytes(reinterpret_cast<char const *>(ptr), size);
+		ptr += size;
+		return bytes;
+	}
+
+	void readPools() {
+		strings = readPool("string table");
+		rpnExpressions = readPool("RPN expression pool");
+	}
+
+	std::string_view readString(char const *what) {
+		uint32_t index = readVarint(what);
+		if (index >= strings.size()) {
+			fatal("%s: Invalid %s: string #%" PRIu32 " does not exist", fileName, what, index);
+		}
+		return strings[index];
+	}
+
+	std::string_view readRPN(char const *what) {
+		uint32_t index = readVarint(what);
+		if (index >= rpnExpressions.size()) {
+			fatal("%s: Invalid %s: RPN #%" PRIu32 " does not exist", fileName, what, index);
+		}
+		return rpnExpressions[index];
+	}
+};
+
+// Reads a file stack node from a compact object file.
+static void readCompactFileStackNode(
+    CompactReader &reader,
+    std::vector<FileStackNode> &fileNodes,
+    uint32_t nodeID,
+    char const *fileName
+) {
+	FileStackNode &node = fileNodes[nodeID];
+
+	if (uint32_t parentID = reader.readOptionalVarint("node parent ID"); parentID == UINT32_MAX) {
+		node.parent = nullptr;
+	} else if (parentID >= fileNodes.size()) {
+		fatal("%s: Node #%" PRIu32 " has invalid parent ID #%" PRIu32, fileName, nodeID, parentID);
+	} else {
+		node.parent = &fileNodes[parentID];
+	}
+	node.lineNo = reader.readVarint("node line number");
+
+	uint8_t typeAndQuiet = reader.readByte("node type");
+	switch (uint8_t type = typeAndQuiet & ~(1 << FSTACKNODE_QUIET_BIT); type) {
+	case NODE_FILE:
+	case NODE_MACRO:
+		node.type = FileStackNodeType(type);
+		node.data = std::string(reader.readString("node file name"));
+		break;
+	case NODE_REPT:
+		node.type = NODE_REPT;
+		node.data = reader.readVarint("node REPT iter");
+		if (!node.parent) {
+			fatal(
+			    "%s: Invalid object file: root node (#%" PRIu32 ") may not be REPT",
+			    fileName,
+			    nodeID
+			);
+		}
+		break;
+	default:
+		fatal("%s: Node #%" PRIu32 " has unknown type 0x%02x", fileName, nodeID, type);
+	}
+
+	node.isQuiet = (typeAndQuiet & (1 << FSTACKNODE_QUIET_BIT)) != 0;
+}
+
+// Reads a symbol from a compact object file.
+static void readCompactSymbol(
+    CompactReader &reader,
+    Symbol &symbol,
+    char const *fileName,
+    std::vector<FileStackNode> const &fileNodes
+) {
+	symbol.name = reader.readString("symbol name");
+
+	if (uint8_t type = reader.readByte("symbol type"); type >= SYMTYPE_INVALID) {
+		fatal("%s: `%s` has unknown type 0x%02x", fileName, symbol.name.c_str(), type);
+	} else {
+		symbol.type = ExportLevel(type);
+	}
+
+	// If the symbol is defined in this file, read its definition
+	if (symbol.type == SYMTYPE_IMPORT) {
+		symbol.data = -1;
+		return;
+	}
+	uint32_t nodeID = reader.readVarint("symbol node ID");
+	if (nodeID >= fileNodes.size()) {
+		fatal("%s: `%s` has invalid node ID #%" PRIu32, fileName, symbol.name.c_str(), nodeID);
+	}
+	symbol.src = &fileNodes[nodeID];
+	symbol.lineNo = reader.readVarint("symbol line number");
+	int32_t sectionID = reader.readOptionalVarint("symbol section ID");
+	int32_t value = reader.readSignedVarint("symbol value");
+	if (sectionID == -1) {
+		symbol.data = value;
+	} else {
+		symbol.data = Label{
+		    .sectionID = sectionID,
+		    .offset = value,
+		    // Set the `.section` later based on the `.sectionID`
+		    .section = nullptr,
+		};
+	}
+}
+
+// Reads a patch from a compact object file.
+static void readCompactPatch(
+    CompactReader &reader,
+    Patch &patch,
+    char const *fileName,
+    std::string const &sectName,
+    uint32_t patchID,
+    std::vector<FileStackNode> const &fileNodes
+) {
+	uint32_t nodeID = reader.readVarint("patch node ID");
+	if (nodeID >= fileNodes.size()) {
+		fatal(
+		    "%s: \"%s\"'s patch #%" PRIu32 " has invalid node ID #%" PRIu32,
+		    fileName,
+		    sectName.c_str(),
+		    patchID,
+		    nodeID
+		);
+	}
+	patch.src = &fileNodes[nodeID];
+	patch.lineNo = reader.readVarint("patch line number");
+	patch.offset = reader.readVarint("patch offset");
+	patch.pcSectionID = reader.readOptionalVarint("patch PC section ID");
+	patch.pcOffset = reader.readVarint("patch PC offset");
+
+	if (uint8_t type = reader.readByte("patch type"); type >= PATCHTYPE_INVALID) {
+		fatal(
+		    "%s: \"%s\"'s patch #%" PRIu32 " has unknown type 0x%02x",
+		    fileName,
+		    sectName.c_str(),
+		    patchID,
+		    type
+		);
+	} else {
+		patch.type = PatchType(type);
+	}
+
+	std::string_view rpn = reader.readRPN("patch RPN expression");
+	patch.rpnExpression.assign(RANGE(rpn));
+}
+
+// Reads a section from a compact object file.
+static void readCompactSection(
+    CompactReader &reader,
+    Section &section,
+    char const *fileName,
+    std::vector<FileStackNode> const &fileNodes
+) {
+	section.name = reader.readString("section name");
+
+	uint32_t nodeID = reader.readVarint("section node ID");
+	if (nodeID >= fileNodes.size()) {
+		fatal("%s: \"%s\" has invalid node ID #%" PRIu32, fileName, section.name.c_str(), nodeID);
+	}
+	section.src = &fileNodes[nodeID];
+	section.lineNo = reader.readVarint("section line number");
+
+	uint32_t size = reader.readVarint("section size");
+	if (size > UINT16_MAX) {
+		fatal(
+		    "%s: \"%s\"'s section size ($%" PRIx32 ") is invalid",
+		    fileName,
+		    section.name.c_str(),
+		    size
+		);
+	}
+	section.size = size;
+	section.offset = 0;
+
+	uint8_t byte = reader.readByte("section type");
+	if (uint8_t type = byte & SECTTYPE_TYPE_MASK; type >= SECTTYPE_INVALID) {
+		fatal("%s: \"%s\" has unknown section type 0x%02x", fileName, section.name.c_str(), type);
+	} else {
+		section.type = SectionType(type);
+	}
+
+	if (byte & (1 << SECTTYPE_UNION_BIT)) {
+		section.modifier = SECTION_UNION;
+	} else if (byte & (1 << SECTTYPE_FRAGMENT_BIT)) {
+		section.modifier = SECTION_FRAGMENT;
+	} else {
+		section.modifier = SECTION_NORMAL;
+	}
+
+	int32_t org = reader.readOptionalVarint("section org");
+	section.isAddressFixed = org >= 0;
+	if (org > UINT16_MAX) {
+		error("\"%s\"'s org is too large ($%" PRIx32 ")", section.name.c_str(), org);
+		org = UINT16_MAX;
+	}
+	section.org = org;
+	int32_t bank = reader.readOptionalVarint("section bank");
+	section.isBankFixed = bank >= 0;
+	section.bank = bank;
+	byte = std::min<uint8_t>(reader.readByte("section alignment"), 16);
+	section.isAlignFixed = byte != 0;
+	section.alignMask = (1 << byte) - 1;
+	uint32_t alignOfs = reader.readVarint("section alignment offset");
+	if (alignOfs > UINT16_MAX) {
+		error(
+		    "\"%s\"'s alignment offset is too large ($%" PRIx32 ")", section.name.c_str(), alignOfs
+		);
+		alignOfs = UINT16_MAX;
+	}
+	section.alignOfs = alignOfs;
+
+	if (sectTypeHasData(section.type)) {
+		std::string_view data = reader.readBytes(section.size, "section data");
+		section.data.assign(RANGE(data));
+
+		section.patches.resize(reader.readVarint("section number of patches"));
+		for (uint32_t i = 0; i < section.patches.size(); ++i) {
+			readCompactPatch(reader, section.patches[i], fileName, section.name, i, fileNodes);
+		}
+	}
+}
+
+// Reads the rest of a compact object file, whose magic has already been read.
+static void readCompactObject(FILE *file, size_t fileID, char const *fileName) {
+	// The whole file is read at once, so that sections can be sought to directly
+	std::vector<uint8_t> contents;
+	uint8_t chunk[BUFSIZ];
+	for (size_t nbRead; (nbRead = fread(chunk, 1, sizeof(chunk), file)) != 0;) {
+		contents.insert(contents.end(), chunk, chunk + nbRead);
+	}
+	if (ferror(file)) {
+		fatal("%s: Cannot read object file: %s", fileName, strerror(errno));
+	}
+	CompactReader reader(contents, fileName);
+
+	if (uint32_t revNum = reader.readVarint("revision number"); revNum != RGBDS_COMPACT_OBJECT_REV) {
+		fatal(
+		    "%s: Unsupported compact object file for rgblink %s; try rebuilding \"%s\"%s"
+		    " (expected revision %d, got %d)",
+		    fileName,
+		    get_package_version_string(),
+		    fileName,
+		    revNum > RGBDS_COMPACT_OBJECT_REV ? " or updating rgblink" : "",
+		    RGBDS_COMPACT_OBJECT_REV,
+		    revNum
+		);
+	}
+	reader.readPools();
+
+	uint32_t nbNodes = reader.readVarint("number of nodes");
+	uint32_t nbSymbols = reader.readVarint("number of symbols");
+	uint32_t nbSections = reader.readVarint("number of sections");
+	uint32_t nbAsserts = reader.readVarint("number of assertions");
+
+	nodes[fileID].resize(nbNodes);
+	verbosePrint(VERB_INFO, "Reading %u nodes...\n", nbNodes);
+	for (uint32_t nodeID = nbNodes; nodeID--;) {
+		readCompactFileStackNode(reader, nodes[fileID], nodeID, fileName);
+	}
+
+	// This file's symbols, kept to link sections to them
+	std::vector<Symbol> &fileSymbols = symbolLists.emplace_front(nbSymbols);
+	std::vector<uint32_t> nbSymPerSect(nbSections, 0);
+
+	verbosePrint(VERB_INFO, "Reading %" PRIu32 " symbols...\n", nbSymbols);
+	for (Symbol &sym : fileSymbols) {
+		readCompactSymbol(reader, sym, fileName, nodes[fileID]);
+		sym_AddSymbol(sym);
+		if (std::holds_alternative<Label>(sym.data)) {
+			int32_t sectionID = std::get<Label>(sym.data).sectionID;
+			if (sectionID < 0 || static_cast<size_t>(sectionID) >= nbSymPerSect.size()) {
+				fatal(
+				    "%s: `%s` has invalid section ID #%" PRId32,
+				    fileName,
+				    sym.name.c_str(),
+				    sectionID
+				);
+			}
+			++nbSymPerSect[sectionID];
+		}
+	}
+
+	// Each section's offset is listed, followed by the assertions' offset
+	std::vector<uint32_t> sectOffsets(nbSections + 1);
+	for (uint32_t &offset : sectOffsets) {
+		offset = reader.readVarint("section offset");
+	}
+	uint8_t const *sectionsStart = reader.pos();
+
+	// This file's sections, stored in a table to link symbols to them
+	std::vector<std::unique_ptr<Section>> fileSections(nbSections);
+
+	verbosePrint(VERB_INFO, "Reading %" PRIu32 " sections...\n", nbSections);
+	for (uint32_t i = 0; i < nbSections; ++i) {
+		reader.seek(sectionsStart, sectOffsets[i], "section");
+		fileSections[i] = std::make_unique<Section>();
+		fileSections[i]->nextPiece = nullptr;
+		readCompactSection(reader, *fileSections[i], fileName, nodes[fileID]);
+		fileSections[i]->fileSymbols = &fileSymbols;
+		fileSections[i]->symbols.reserve(nbSymPerSect[i]);
+	}
+
+	reader.seek(sectionsStart, sectOffsets[nbSections], "assertions");
+	verbosePrint(VERB_INFO, "Reading %" PRIu32 " assertions...\n", nbAsserts);
+	for (uint32_t i = 0; i < nbAsserts; ++i) {
+		Assertion &assertion = patch_AddAssertion();
+
+		readCompactPatch(
+		    reader, assertion.patch, fileName, "Assertion #" + std::to_string(i), 0, nodes[fileID]
+		);
+		assertion.message = reader.readString("assertion message");
+
+		if (assertion.patch.pcSectionID == UINT32_MAX) {
+			assertion.patch.pcSection = nullptr;
+		} else if (assertion.patch.pcSectionID >= fileSections.size()) {
+			fatal(
+			    "%s: Assertion #%" PRIu32 "'s patch has invalid section ID #%" PRIu32,
+			    fileName,
+			    i,
+			    assertion.patch.pcSectionID
+			);
+		} else {
+			assertion.patch.pcSection = fileSections[assertion.patch.pcSectionID].get();
+		}
+
+		assertion.fileSymbols = &fileSymbols;
+	}
+
+	linkFileSections(fileSymbols, fileSections, fileName);
+}
+
 void obj_ReadFile(std::string const &filePath, size_t fileID) {
 	FILE *file;
 	char const *fileName = filePath.c_str();
@@ -458,7 +901,7 @@ void obj_ReadFile(std::string const &filePath, size_t fileID) {
 		// object file. It's better than nothing.
 		nodes[fileID].push_back({
 		    .type = NODE_FILE,
-		    .data = std::variant<std::monostate, std::vector<uint32_t>, std::string>(fileName),
+		    .data = std::variant<std::monostate, uint32_t, std::string>(fileName),
 		    .isQuiet = false,
 		    .parent = nullptr,
 		    .lineNo = 0,
@@ -471,11 +914,21 @@ void obj_ReadFile(std::string const &filePath, size_t fileID) {
 	}
 
 	case 'R':
-		// Check the magic byte signature for a RGB object file.
+		// Check the magic byte signature for a RGB object file, either classic or compact.
+		static_assert(
+		    literal_strlen(RGBDS_OBJECT_VERSION_STRING)
+		    == literal_strlen(RGBDS_COMPACT_OBJECT_VERSION_STRING)
+		);
 		if (char magic[literal_strlen(RGBDS_OBJECT_VERSION_STRING)];
-		    fread(magic, 1, sizeof(magic), file) == sizeof(magic)
-		    && !memcmp(magic, RGBDS_OBJECT_VERSION_STRING, sizeof(magic))) {
-			break;
+		    fread(magic, 1, sizeof(magic), file) == sizeof(magic)) {
+			if (!memcmp(magic, RGBDS_OBJECT_VERSION_STRING, sizeof(magic))) {
+				break;
+			}
+			if (!memcmp(magic, RGBDS_COMPACT_OBJECT_VERSION_STRING, sizeof(magic))) {
+				verbosePrint(VERB_NOTICE, "Reading compact object file %s\n", fileName);
+				readCompactObject(file, fileID, fileName);
+				return;
+			}
 		}
 		[[fallthrough]];
 
@@ -572,46 +1025,7 @@ void obj_ReadFile(std::string const &filePath, size_t fileID) {
 		assertion.fileSymbols = &fileSymbols;
 	}
 
-	// Give patches' PC section pointers to their sections
-	for (std::unique_ptr<Section> const &sect : fileSections) {
-		if (!sectTypeHasData(sect->type)) {
-			continue;
-		}
-		for (size_t i = 0; i < sect->patches.size(); ++i) {
-			if (Patch &patch = sect->patches[i]; patch.pcSectionID == UINT32_MAX) {
-				patch.pcSection = nullptr;
-			} else if (patch.pcSectionID >= fileSections.size()) {
-				fatal(
-				    "%s: \"%s\"'s patch #%zu has invalid section ID #%" PRIu32,
-				    fileName,
-				    sect->name.c_str(),
-				    i,
-				    patch.pcSectionID
-				);
-			} else {
-				patch.pcSection = fileSections[patch.pcSectionID].get();
-			}
-		}
-	}
-
-	// Give symbols' section pointers to their sections
-	for (Symbol &sym : fileSymbols) {
-		if (std::holds_alternative<Label>(sym.data)) {
-			sym.linkToSection(*fileSections[std::get<Label>(sym.data).sectionID]);
-		}
-	}
-
-	// Calling `sect_AddSection` invalidates the contents of `fileSections`!
-	for (uint32_t i = 0; i < nbSections; ++i) {
-		sect_AddSection(std::move(fileSections[i]));
-	}
-
-	// Fix symbols' section pointers to section "pieces"
-	// This has to run **after** all the `sect_AddSection()` calls,
-	// so that `sect_GetSection()` will work
-	for (Symbol &sym : fileSymbols) {
-		sym.fixSectionOffset();
-	}
+	linkFileSections(fileSymbols, fileSections, fileName);
 }
 
 void obj_Setup(size_t nbFiles) {
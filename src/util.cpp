@@ -2,6 +2,8 @@
 
 #include "util.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <errno.h>
 #include <optional>
 #include <stdint.h>
@@ -11,6 +13,27 @@
 #include "helpers.hpp" // assume
 #include "platform.hpp"
 
+// SSE2 is always available on x86-64, but AVX2 has to be checked for at runtime
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define HAVE_SSE2 1
+#else
+	#define HAVE_SSE2 0
+#endif
+#if HAVE_SSE2 && defined(__GNUC__)
+	#include <immintrin.h>
+	#define HAVE_AVX2 1
+#else
+	#define HAVE_AVX2 0
+#endif
+// NEON is always available on AArch64
+#if defined(__aarch64__) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define HAVE_NEON 1
+#else
+	#define HAVE_NEON 0
+#endif
+
 int xfclose(FILE *file) {
 	if (file == stdin || file == stdout || file == stderr) {
 		return 0;
@@ -43,6 +66,72 @@ bool isNewline(int c) {
 	return c == '\r' || c == '\n';
 }
 
+static char const *findNewlineScalar(char const *ptr, char const *end) {
+	return std::find_if(ptr, end, isNewline);
+}
+
+#if HAVE_SSE2
+static char const *findNewlineSSE2(char const *ptr, char const *end) {
+	__m128i const lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+	for (; end - ptr >= 16; ptr += 16) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(ptr));
+		__m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr));
+		if (uint32_t mask = _mm_movemask_epi8(matches); mask != 0) {
+			return ptr + std::countr_zero(mask);
+		}
+	}
+	return findNewlineScalar(ptr, end);
+}
+#endif
+
+#if HAVE_AVX2
+[[gnu::target("avx2")]]
+static char const *findNewlineAVX2(char const *ptr, char const *end) {
+	__m256i const lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+	for (; end - ptr >= 32; ptr += 32) {
+		__m256i chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(ptr));
+		__m256i matches =
+		    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lf), _mm256_cmpeq_epi8(chunk, cr));
+		if (uint32_t mask = _mm256_movemask_epi8(matches); mask != 0) {
+			return ptr + std::countr_zero(mask);
+		}
+	}
+	return findNewlineSSE2(ptr, end);
+}
+#endif
+
+#if HAVE_NEON
+static char const *findNewlineNEON(char const *ptr, char const *end) {
+	uint8x16_t const lf = vdupq_n_u8('\n'), cr = vdupq_n_u8('\r');
+	for (; end - ptr >= 16; ptr += 16) {
+		uint8x16_t chunk = vld1q_u8(reinterpret_cast<uint8_t const *>(ptr));
+		if (vmaxvq_u8(vorrq_u8(vceqq_u8(chunk, lf), vceqq_u8(chunk, cr))) != 0) {
+			return findNewlineScalar(ptr, ptr + 16);
+		}
+	}
+	return findNewlineScalar(ptr, end);
+}
+#endif
+
+char const *findNewline(char const *ptr, char const *end) {
+	// Select the widest implementation supported by the running CPU, once
+	static char const *(*const impl)(char const *, char const *) = []() {
+#if HAVE_AVX2
+		if (__builtin_cpu_supports("avx2")) {
+			return findNewlineAVX2;
+		}
+#endif
+#if HAVE_SSE2
+		return findNewlineSSE2;
+#elif HAVE_NEON
+		return findNewlineNEON;
+#else
+		return findNewlineScalar;
+#endif
+	}();
+	return impl(ptr, end);
+}
+
 bool isBlankSpace(int c) {
 	return c == ' ' || c == '\t';
 }
@@ -0,0 +1,22 @@
+opt Wno-unmapped-char
+
+SECTION "test", ROM0
+
+; Enough mappings after "<" for it to be looked up densely
+FOR I, 20
+	CHARMAP STRCAT("<", STRSLICE("abcdefghijklmnopqrst", I, I + 1)), I
+ENDR
+CHARMAP "<aa>", $80
+CHARMAP "<abc>", $81, $82
+
+	db "<a<aa><abc<abc>"
+	db "<t<u<aa<<b"
+
+; Mappings added after converting strings must be used
+CHARMAP "<u", $90
+CHARMAP "<ab", $91
+	db "<t<u<ab<abc>"
+
+; Redefined mappings must be used too
+CHARMAP "<a", $a0, $a1
+	db "<a<aa>"
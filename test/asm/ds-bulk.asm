@@ -0,0 +1,13 @@
+SECTION "Fills", ROM0
+	ds 4
+	ds 6, $12, $34, $56, $78
+	db "abc"
+	dw "de"
+	dl "f"
+
+SECTION "Code", ROM0
+	LOAD "RAM", WRAM0
+Start:
+	ds 3, $AB
+	db "gh"
+	ENDL
@@ -1,3 +1,5 @@
 SECTION "Test", ROM0
 
 INCBIN "empty.bin"
+INCBIN "empty.bin", 0
+INCBIN "empty.bin", 0, 0
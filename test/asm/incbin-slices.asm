@@ -0,0 +1,7 @@
+SECTION "Slices", ROM0
+
+; Slicing the same file many times reuses its loaded contents
+FOR OFS, 0, 112, 16
+	INCBIN "data.bin", OFS, 16
+ENDR
+INCBIN "data.bin", 112
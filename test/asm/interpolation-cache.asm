@@ -0,0 +1,42 @@
+; The same interpolations are repeated, with their symbols changing in between
+
+DEF n = 42
+	println "{n} {d:n} {x:n} {d:n} {n}"
+DEF n += 1
+	println "{n} {d:n} {x:n} {d:n} {n}"
+
+DEF s EQUS "hello"
+	println "{s} {8s:s} {s}"
+REDEF s EQUS "world"
+	println "{s} {8s:s} {s}"
+PURGE s
+DEF s EQU 7
+	println "{s} {d:s}"
+PURGE s
+DEF s EQUS "again"
+	println "{s} {d:n}"
+
+FOR i, 3
+	println "i={d:i}, i={d:i}, n={d:n}"
+DEF n *= 2
+ENDR
+
+MACRO show
+	println "\1={d:\1}"
+ENDM
+	show n
+	show i
+
+SECTION "labels", ROM0[$100]
+Label:
+	println "{Label}"
+	ds 2
+Label2:
+	println "{Label2}"
+
+DEF f EQU 1.5
+	println "{f:f} {.3f:f}"
+OPT Q8
+	println "{f:f} {.3f:f}"
+	println "{.300f:f}" ; reported every time
+	println "{.300f:f}"
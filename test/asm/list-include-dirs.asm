@@ -0,0 +1,10 @@
+INCLUDE "include-slash.inc"
+println x
+PURGE x
+INCLUDE "./include/include-slash.inc"
+println x
+PURGE x
+INCLUDE "include-slash.inc"
+println x
+INCLUDE "include-slash-nonexist.inc"
+INCLUDE "include-slash-nonexist.inc"
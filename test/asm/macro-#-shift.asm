@@ -0,0 +1,24 @@
+MACRO rest
+	println "{d:_NARG}: <\#>"
+	if _NARG > 0
+		shift
+		rest \#
+	endc
+ENDM
+
+	rest a, b, c
+	rest x,, y,
+
+MACRO walk
+	println "<\#> <\<-1>>"
+	shift 2
+	println "<\#>"
+	shift -1
+	println "<\#> <\1>"
+	shift 5
+	println "<\#>"
+	shift -2
+	println "<\#> <\1>"
+ENDM
+
+	walk 1, 22, 333,
@@ -0,0 +1,28 @@
+; The same text in a loop body may lex differently on each iteration
+
+DEF n = 0
+REPT 3
+	; `word` only becomes an `EQUS` after the first iteration
+	IF DEF(word)
+		PRINTLN "word is ", word
+	ELIF n == 0
+		PRINTLN "no word yet"
+	ELIF n == 1
+		PRINTLN "not reached"
+	ENDC
+	REDEF word EQUS "{d:n}"
+
+	; Fixed-point precision changes after the first iteration
+	PRINTLN 1.5
+	OPT Q8
+
+	; Warnings are reported on each iteration
+	PRINTLN $1_0000_0000
+
+	DEF n += 1
+ENDR
+
+SECTION "anon", ROM0
+REPT 2
+:	db :- & $FF
+ENDR
@@ -0,0 +1,20 @@
+SECTION "Fixed", ROM0[$0000]
+	ASSERT Target == $10
+	jp Target
+	ld hl, Target + 1
+	jr Target
+	db HIGH(Target), LOW(End - Start)
+	dw BANK("Floating"), STARTOF(ROM0)
+	ds 2
+Target:
+	ld a, a
+
+SECTION "Floating", ROM0
+Start:
+	ASSERT End - Start == 6
+	dw End - Start, Start ; Only the difference is known before linking
+	ldh a, [HRAMValue]
+End:
+	jr Start ; Only the distance to the target is needed
+
+DEF HRAMValue EQU $FF80
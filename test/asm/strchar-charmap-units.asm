@@ -0,0 +1,39 @@
+SECTION "test", ROM0
+
+	; Without any mappings, units are UTF-8 codepoints
+	assert CHARLEN("héllo") == 5
+	println STRCHAR("héllo", 1), STRCHAR("héllo", -1)
+
+	charmap "A", 1
+	charmap "B", 2
+	charmap "AB", 3
+	charmap "<END>", 4
+
+DEF S EQUS "ABAB<END>BA"
+
+	; Units are the longest mappings: AB, AB, <END>, B, A
+	assert CHARLEN("{S}") == 5
+	FOR I, CHARLEN("{S}")
+		println STRCHAR("{S}", I), " ", CHARSUB("{S}", I + 1)
+	ENDR
+	println STRCHAR("{S}", -2)
+	println STRCHAR("{S}", 5)
+	println CHARSUB("{S}", 6)
+	println STRCHAR("", 0)
+
+	; Mappings added since the string was last used change its units
+	charmap "BA", 5
+	assert CHARLEN("{S}") == 4
+	println STRCHAR("{S}", 3)
+
+	; Unmapped characters are still warned about
+	assert CHARLEN("A?B") == 3
+	println STRCHAR("A?B", 2)
+
+	; Other charmaps split the string their own way
+	newcharmap other, main
+	charmap "ABA", 6
+	assert CHARLEN("{S}") == 4
+	println STRCHAR("{S}", 0), " ", STRCHAR("{S}", 1)
+	setcharmap main
+	assert CHARLEN("{S}") == 4
@@ -0,0 +1,23 @@
+DEF text EQUS "Pokémon → ポケモン!"
+
+; Reuses the last string's character offsets
+FOR I, STRLEN("{text}")
+	PRINT STRSLICE("{text}", I, I + 1), "|"
+ENDR
+	PRINTLN
+
+; Alternates between strings, including an ASCII one
+FOR I, 4
+	PRINTLN STRSLICE("{text}", -I - 1), " ", STRSLICE("ASCII", I), " ", STRSLICE("日本語", 0, I)
+ENDR
+
+	PRINTLN STRSLICE("{text}", 12, 14)
+	PRINTLN STRSLICE("{text}", 15, 20)
+	PRINTLN STRSLICE("{text}", 17, 20)
+	PRINTLN STRSLICE("{text}", 18)
+	PRINTLN STRSLICE("{text}", 3, 1)
+	PRINTLN STRLEN("{text}"), " ", STRLEN("日本語"), " ", STRLEN("")
+
+	PRINTLN STRSUB("{text}", 9, 4)
+	PRINTLN STRSUB("{text}", 16, 3)
+	PRINTLN STRSUB("{text}", 18, 1)
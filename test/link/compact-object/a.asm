@@ -0,0 +1,17 @@
+; Assembled as a compact object, linked with a classic one
+section "entry", rom0[$100]
+Entry::
+	rept 3
+		call Helper
+	endr
+	jp Far
+	db -2, Count
+
+section union "shared", wram0
+Buffer:: ds 4
+
+section "floating", rom0
+Local:
+	ld a, BANK(Far)
+	dw Local, Local - Entry
+	assert Local < Entry, "\"floating\" is placed after \"entry\""
@@ -0,0 +1,14 @@
+def Count equ -3
+export Count
+
+section "helper", rom0[$200]
+Helper::
+	ld hl, Buffer + 2
+	ret
+
+section "far", rom0
+Far::
+	jr Far
+
+section union "shared", wram0
+	ds 8